@@ -0,0 +1,152 @@
+#include "BenchRunner.h"
+#include "Log.h"
+#include "nlohmann/json.hpp"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+volatile long long benchSink = 0;
+
+// 最近秩法取分位数，values 已排序
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t rank = (size_t)std::ceil(p * sorted.size());
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+}  // namespace
+
+void benchKeep(long long value) {
+    benchSink = benchSink + value;
+}
+
+BenchRunner::BenchRunner(const std::string& filter) : filter(filter) {}
+
+bool BenchRunner::isEnabled(const std::string& name) const {
+    return filter.empty() || name.find(filter) != std::string::npos;
+}
+
+const char* BenchRunner::getUnitName(Unit unit) {
+    return unit == UNIT_MS ? "ms/op" : "ns/op";
+}
+
+void BenchRunner::run(const std::string& name, Unit unit, int samples, int opsPerSample,
+                      const std::function<void()>& sample, int warmupSamples) {
+    if (!isEnabled(name)) {
+        return;
+    }
+    for (int i = 0; i < warmupSamples; ++i) {
+        sample();
+    }
+
+    const double ticksToUnit = (unit == UNIT_MS ? 1e3 : 1e9) / (double)SDL_GetPerformanceFrequency();
+    std::vector<double> values;
+    values.reserve(samples);
+    for (int i = 0; i < samples; ++i) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        sample();
+        Uint64 elapsed = SDL_GetPerformanceCounter() - start;
+        values.push_back(elapsed * ticksToUnit / opsPerSample);
+    }
+    results.push_back(computeStats(name, unit, opsPerSample, std::move(values)));
+    const Result& r = results.back();
+    LOG_INFO(CAT_PERF, "[bench] " << r.name << ": p50 " << r.p50 << " " << r.unit);
+}
+
+void BenchRunner::addSamples(const std::string& name, const std::vector<double>& sampleMs) {
+    if (!isEnabled(name) || sampleMs.empty()) {
+        return;
+    }
+    results.push_back(computeStats(name, UNIT_MS, 1, sampleMs));
+}
+
+BenchRunner::Result BenchRunner::computeStats(const std::string& name, Unit unit, int opsPerSample,
+                                              std::vector<double> values) {
+    Result r;
+    r.name = name;
+    r.unit = getUnitName(unit);
+    r.samples = (int)values.size();
+    r.opsPerSample = opsPerSample;
+    if (values.empty()) {
+        return r;
+    }
+
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (double v : values) {
+        sum += v;
+    }
+    r.mean = sum / values.size();
+    double squares = 0.0;
+    for (double v : values) {
+        squares += (v - r.mean) * (v - r.mean);
+    }
+    r.stddev = values.size() > 1 ? std::sqrt(squares / (values.size() - 1)) : 0.0;
+    r.min = values.front();
+    r.max = values.back();
+    r.p50 = percentile(values, 0.50);
+    r.p95 = percentile(values, 0.95);
+    r.p99 = percentile(values, 0.99);
+    return r;
+}
+
+void BenchRunner::printTable() const {
+    std::printf("%-40s %8s %12s %12s %12s %12s %10s\n", "benchmark", "unit", "p50", "p95", "p99", "mean",
+                "stddev");
+    for (const Result& r : results) {
+        std::printf("%-40s %8s %12.3f %12.3f %12.3f %12.3f %10.3f\n", r.name.c_str(), r.unit.c_str(), r.p50, r.p95,
+                    r.p99, r.mean, r.stddev);
+    }
+    std::fflush(stdout);
+}
+
+bool BenchRunner::writeJson(const std::string& path) const {
+    nlohmann::json out;
+    out["format"] = "echogidge-bench";
+    out["version"] = 1;
+    out["results"] = nlohmann::json::array();
+    for (const Result& r : results) {
+        out["results"].push_back({
+            {"name", r.name}, {"unit", r.unit}, {"samples", r.samples}, {"opsPerSample", r.opsPerSample},
+            {"min", r.min}, {"p50", r.p50}, {"p95", r.p95}, {"p99", r.p99}, {"max", r.max},
+            {"mean", r.mean}, {"stddev", r.stddev}
+        });
+    }
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        LOG_ERROR(CAT_PERF, "无法写入基准结果: " << path);
+        return false;
+    }
+    file << out.dump(2) << "\n";
+    if (!file.good()) {
+        LOG_ERROR(CAT_PERF, "基准结果写入失败: " << path);
+        return false;
+    }
+    LOG_INFO(CAT_PERF, "基准结果已写入 " << path);
+    return true;
+}
+
+bool BenchRunner::writeCsv(const std::string& path) const {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        LOG_ERROR(CAT_PERF, "无法写入基准结果: " << path);
+        return false;
+    }
+    std::fprintf(file, "name,unit,samples,ops_per_sample,min,p50,p95,p99,max,mean,stddev\n");
+    for (const Result& r : results) {
+        std::fprintf(file, "%s,%s,%d,%d,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f\n", r.name.c_str(), r.unit.c_str(),
+                     r.samples, r.opsPerSample, r.min, r.p50, r.p95, r.p99, r.max, r.mean, r.stddev);
+    }
+    bool ok = std::fclose(file) == 0;
+    if (ok) {
+        LOG_INFO(CAT_PERF, "基准结果已写入 " << path);
+    } else {
+        LOG_ERROR(CAT_PERF, "基准结果写入失败: " << path);
+    }
+    return ok;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+
+// 基准测试的计时和统计：每个用例先预热，再重复测若干个样本，
+// 每个样本执行 opsPerSample 次操作，结果按单次操作的耗时统计。
+class BenchRunner {
+public:
+    enum Unit {
+        UNIT_NS,  // 纳秒/次，适合查询类热点
+        UNIT_MS   // 毫秒/次，适合加载、整帧绘制
+    };
+
+    struct Result {
+        std::string name;
+        std::string unit;
+        int samples = 0;
+        int opsPerSample = 0;
+        double min = 0.0;
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+        double mean = 0.0;
+        double stddev = 0.0;
+    };
+
+    // filter 非空时只运行名字包含该子串的用例
+    explicit BenchRunner(const std::string& filter = "");
+
+    bool isEnabled(const std::string& name) const;
+
+    // sample 执行一个样本（opsPerSample 次操作）；用例被过滤掉时什么也不做
+    void run(const std::string& name, Unit unit, int samples, int opsPerSample,
+             const std::function<void()>& sample, int warmupSamples = 2);
+
+    // 调用方自己测好的样本（毫秒），例如帧时间回归里每帧的更新/渲染耗时
+    void addSamples(const std::string& name, const std::vector<double>& sampleMs);
+
+    const std::vector<Result>& getResults() const { return results; }
+
+    void printTable() const;
+    bool writeJson(const std::string& path) const;
+    bool writeCsv(const std::string& path) const;
+
+    static const char* getUnitName(Unit unit);
+    static Result computeStats(const std::string& name, Unit unit, int opsPerSample, std::vector<double> values);
+
+private:
+    std::string filter;
+    std::vector<Result> results;
+};
+
+// 防止编译器把被测代码当作无用计算优化掉
+void benchKeep(long long value);
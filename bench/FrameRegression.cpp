@@ -0,0 +1,174 @@
+#include "FrameRegression.h"
+#include "Game.h"
+#include "Log.h"
+#include "nlohmann/json.hpp"
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+const char* const BASELINE_FORMAT = "echogidge-frame-baseline";
+const char* const METRICS[] = {"frame/update", "frame/render", "frame/total"};
+const char* const PERCENTILES[] = {"p50", "p95", "p99"};
+
+// 基线文件里没有写容差时的默认值：p99 受系统抖动影响最大，放得最宽
+nlohmann::json defaultTolerance() {
+    return {{"p50", 0.10}, {"p95", 0.15}, {"p99", 0.25}, {"absoluteMs", 0.05}};
+}
+
+double percentileOf(const BenchRunner::Result& result, const std::string& name) {
+    if (name == "p50") return result.p50;
+    if (name == "p95") return result.p95;
+    return result.p99;
+}
+
+const BenchRunner::Result* findResult(const BenchRunner& bench, const std::string& name) {
+    for (const BenchRunner::Result& result : bench.getResults()) {
+        if (result.name == name) {
+            return &result;
+        }
+    }
+    return nullptr;
+}
+
+nlohmann::json loadBaseline(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return nlohmann::json();
+    }
+    nlohmann::json baseline = nlohmann::json::parse(file, nullptr, false);
+    if (baseline.is_discarded() || !baseline.is_object() || baseline.value("format", "") != BASELINE_FORMAT) {
+        LOG_ERROR(CAT_PERF, "帧时间基线格式不对: " << path);
+        return nlohmann::json();
+    }
+    return baseline;
+}
+
+bool writeBaseline(const std::string& path, nlohmann::json baseline, const BenchRunner& bench,
+                   const std::string& source, int frames) {
+    if (!baseline.is_object()) {
+        baseline = nlohmann::json::object();
+    }
+    baseline["format"] = BASELINE_FORMAT;
+    baseline["version"] = 1;
+    baseline["source"] = source;
+    baseline["renderer"] = "software";
+    baseline["frames"] = frames;
+    if (!baseline.contains("tolerance")) {
+        baseline["tolerance"] = defaultTolerance();
+    }
+    baseline.erase("note");
+    nlohmann::json metrics = nlohmann::json::object();
+    for (const char* metric : METRICS) {
+        const BenchRunner::Result* result = findResult(bench, metric);
+        if (result) {
+            metrics[metric] = {{"p50", result->p50}, {"p95", result->p95}, {"p99", result->p99}};
+        }
+    }
+    baseline["metrics"] = metrics;
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        LOG_ERROR(CAT_PERF, "无法写入帧时间基线: " << path);
+        return false;
+    }
+    file << baseline.dump(2) << "\n";
+    LOG_INFO(CAT_PERF, "帧时间基线已更新: " << path);
+    return file.good();
+}
+
+}  // namespace
+
+bool FrameRegression::run(const Options& options, BenchRunner& bench) {
+    GameOptions gameOptions;
+    gameOptions.headless = true;
+    gameOptions.headlessRender = true;
+    gameOptions.headlessRuns = options.runs;
+    gameOptions.headlessMaxTicks = options.maxTicks;
+    gameOptions.replayPath = options.replayPath;
+
+    std::vector<Game::FrameTiming> timings;
+    {
+        Game game(gameOptions);
+        game.run();
+        timings = game.getFrameTimings();
+    }
+
+    const int frames = (int)timings.size() - options.warmupFrames;
+    if (frames < 60) {
+        LOG_ERROR(CAT_PERF, "帧时间回归只采到 " << timings.size() << " 帧，无法统计（回放或地图加载失败？）");
+        return false;
+    }
+
+    std::vector<double> updateMs, renderMs, totalMs;
+    for (size_t i = options.warmupFrames; i < timings.size(); ++i) {
+        updateMs.push_back(timings[i].updateMs);
+        renderMs.push_back(timings[i].renderMs);
+        totalMs.push_back(timings[i].updateMs + timings[i].renderMs);
+    }
+    bench.addSamples("frame/update", updateMs);
+    bench.addSamples("frame/render", renderMs);
+    bench.addSamples("frame/total", totalMs);
+
+    // 只记文件名：CMake 目标传的是源码目录下的绝对路径，换台机器不应算作来源不同
+    const std::string source =
+        options.replayPath.empty() ? "autopilot" : std::filesystem::u8path(options.replayPath).filename().u8string();
+    nlohmann::json baseline = loadBaseline(options.baselinePath);
+    if (options.updateBaseline) {
+        return writeBaseline(options.baselinePath, baseline, bench, source, frames);
+    }
+    if (!baseline.is_object()) {
+        LOG_ERROR(CAT_PERF, "没有可用的帧时间基线: " << options.baselinePath << "，先用 --update-baseline 生成");
+        return false;
+    }
+    if (baseline.value("source", source) != source) {
+        LOG_WARN(CAT_PERF, "基线录自 " << baseline.value("source", "") << "，本次运行的是 " << source);
+    }
+
+    nlohmann::json tolerance = defaultTolerance();
+    if (baseline.contains("tolerance") && baseline["tolerance"].is_object()) {
+        tolerance.update(baseline["tolerance"]);
+    }
+    const double absoluteMs = tolerance.value("absoluteMs", 0.0);
+    const nlohmann::json metrics = baseline.value("metrics", nlohmann::json::object());
+    if (!metrics.is_object() || metrics.empty()) {
+        LOG_ERROR(CAT_PERF, "帧时间基线 " << options.baselinePath << " 没有 metrics，先用 --update-baseline 生成");
+        return false;
+    }
+
+    // 基线缺指标或分位数都算失败，否则基线写坏了回归检查也会一直通过
+    bool passed = true;
+    for (const char* metric : METRICS) {
+        const BenchRunner::Result* result = findResult(bench, metric);
+        if (!result) {
+            continue;  // 被 --filter 过滤掉了
+        }
+        if (!metrics.contains(metric) || !metrics[metric].is_object()) {
+            LOG_ERROR(CAT_PERF, "基线中没有 " << metric << "，用 --update-baseline 重新生成");
+            passed = false;
+            continue;
+        }
+        for (const char* percentile : PERCENTILES) {
+            if (!metrics[metric].contains(percentile) || !metrics[metric][percentile].is_number()) {
+                LOG_ERROR(CAT_PERF, "基线中没有 " << metric << " " << percentile << "，用 --update-baseline 重新生成");
+                passed = false;
+                continue;
+            }
+            const double expected = metrics[metric][percentile].get<double>();
+            const double actual = percentileOf(*result, percentile);
+            const double relative = tolerance.value(percentile, 0.0);
+            const double limit = expected * (1.0 + relative) + absoluteMs;
+            if (actual > limit) {
+                LOG_ERROR(CAT_PERF, "[回归] " << metric << " " << percentile << " = " << actual << " ms，基线 "
+                                    << expected << " ms，上限 " << limit << " ms");
+                passed = false;
+            } else if (actual < expected * (1.0 - relative)) {
+                LOG_INFO(CAT_PERF, metric << " " << percentile << " = " << actual << " ms，比基线 " << expected
+                                   << " ms 快，确认后可用 --update-baseline 更新基线");
+            }
+        }
+    }
+    LOG_INFO(CAT_PERF, "帧时间回归" << (passed ? "通过" : "失败") << "（" << frames << " 帧，来源 " << source << "）");
+    return passed;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "BenchRunner.h"
+#include <string>
+
+// 帧时间回归：用软件渲染器无界面地跑一遍回放（没有回放文件时用固定种子的自动驾驶跑几局），
+// 统计每帧的更新/渲染耗时，与仓库里的基线 JSON 对比 p50/p95/p99，超出容差即判为回归。
+// 基线缺少任何一项指标都判为失败（--update-baseline 除外）。
+class FrameRegression {
+public:
+    struct Options {
+        std::string replayPath;     // 空时用自动驾驶
+        std::string baselinePath;
+        bool updateBaseline = false;  // 用本次结果覆盖基线（容差设置保留）
+        int runs = 3;                 // 自动驾驶跑几局（一局可能很快就死掉）
+        int maxTicks = 120 * 30;      // 自动驾驶每局最多模拟的步数
+        int warmupFrames = 30;        // 开头几帧要烘焙分块缓存、首次上传纹理，不计入统计
+    };
+
+    // 返回 false 表示运行失败或有指标回归
+    static bool run(const Options& options, BenchRunner& bench);
+};
@@ -0,0 +1,282 @@
+#include "BenchRunner.h"
+#include "Camera.h"
+#include "Coin.hpp"
+#include "FrameRegression.h"
+#include "Log.h"
+#include "TextureAtlas.h"
+#include "TextureCache.h"
+#include "TiledMap.h"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// EchoGidgeBench：不开窗口的基准测试，覆盖地图加载、碰撞查询、金币和瓦片绘制热点。
+// 用法：EchoGidgeBench [--map=文件.tmj] [--filter=子串] [--json=结果.json] [--csv=结果.csv]
+//       EchoGidgeBench --frames[=回放.egrp] [--baseline=基线.json] [--update-baseline]
+// 需要在有 assets 目录的地方运行（构建目录里 EchoGidge 旁边）。
+
+namespace {
+
+const int SCREEN_WIDTH = 800;   // 与 Game 的窗口尺寸一致
+const int SCREEN_HEIGHT = 350;
+
+#ifndef ECHOGIDGE_BENCH_BASELINE_DIR
+#define ECHOGIDGE_BENCH_BASELINE_DIR "bench/baselines"
+#endif
+
+struct BenchOptions {
+    std::string mapPath = "assets/maps/level1.tmj";
+    std::string filter;
+    std::string jsonPath;
+    std::string csvPath;
+    bool frames = false;  // 帧时间回归模式，不跑微基准
+    FrameRegression::Options frameOptions;
+};
+
+bool writeResults(const BenchRunner& bench, const BenchOptions& options) {
+    bench.printTable();
+    bool ok = true;
+    if (!options.jsonPath.empty() && !bench.writeJson(options.jsonPath)) {
+        ok = false;
+    }
+    if (!options.csvPath.empty() && !bench.writeCsv(options.csvPath)) {
+        ok = false;
+    }
+    return ok;
+}
+
+// 固定种子的查询点，覆盖整张地图并向外多出一圈（出界也是常见查询）
+std::vector<SDL_Point> makeQueryPoints(const TiledMap& map, int count) {
+    std::vector<SDL_Point> points;
+    points.reserve(count);
+    const int margin = 64;
+    const int w = map.getContentPixelWidth() + margin * 2;
+    const int h = map.getContentPixelHeight() + margin * 2;
+    uint32_t seed = 12345;
+    for (int i = 0; i < count; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        int x = (int)((seed >> 8) % (uint32_t)w) - margin;
+        seed = seed * 1664525u + 1013904223u;
+        int y = (int)((seed >> 8) % (uint32_t)h) - margin;
+        points.push_back({x, y});
+    }
+    return points;
+}
+
+void benchMapLoad(BenchRunner& bench, const BenchOptions& options, SDL_Renderer* softRenderer) {
+    bench.run("map/load_headless", BenchRunner::UNIT_MS, 10, 1, [&] {
+        TiledMap map(options.mapPath, nullptr, false);
+        benchKeep(map.getMapPixelWidth());
+    });
+    // 同一张地图编译成 .egmap 后的映射加载（临时文件，测完删除）
+    if (bench.isEnabled("map/load_compiled")) {
+        const std::string compiledPath = "echogidge_bench.egmap";
+        if (TiledMap(options.mapPath, nullptr, false).saveCompiled(compiledPath)) {
+            bench.run("map/load_compiled", BenchRunner::UNIT_MS, 10, 1, [&] {
+                TiledMap map(compiledPath, nullptr);
+                benchKeep(map.getMapPixelWidth());
+            });
+        }
+        std::remove(compiledPath.c_str());
+    }
+    // 冷加载：每次先清空纹理缓存；热加载：纹理都还在缓存里（比如回到菜单后重新进入关卡）。
+    // 两者都解析 .tmj（allowCompiled=false），旁边有 .egmap 时也不走映射加载，和 load_headless 可比
+    bench.run("map/load_software", BenchRunner::UNIT_MS, 5, 1, [&] {
+        TextureAtlas::releaseRenderer(softRenderer);
+        TextureCache::releaseRenderer(softRenderer);
+        TiledMap map(options.mapPath, softRenderer, false);
+        benchKeep(map.getMapPixelWidth());
+    });
+    bench.run("map/load_software_cached", BenchRunner::UNIT_MS, 5, 1, [&] {
+        TiledMap map(options.mapPath, softRenderer, false);
+        benchKeep(map.getMapPixelWidth());
+    });
+    // 重开一局时复用已加载的地图：吃掉所有金币再还原（与上面的完整加载对比）
+    if (bench.isEnabled("map/restart_resident")) {
+        TiledMap map(options.mapPath, softRenderer);
+        const std::vector<SDL_FPoint> coinPositions = map.getCoinPositions();
+        bench.run("map/restart_resident", BenchRunner::UNIT_MS, 30, 1, [&] {
+            for (const SDL_FPoint& p : coinPositions) {
+                map.clearCoinTileAt((int)p.x, (int)p.y);
+            }
+            map.restorePristine();
+            benchKeep((long long)coinPositions.size());
+        });
+    }
+}
+
+void benchMapQueries(BenchRunner& bench, const TiledMap& map) {
+    const std::vector<SDL_Point> points = makeQueryPoints(map, 65536);
+    const int ops = (int)points.size();
+
+    bench.run("map/isColliding", BenchRunner::UNIT_NS, 50, ops, [&] {
+        long long hits = 0;
+        for (const SDL_Point& p : points) {
+            hits += map.isColliding(p.x, p.y);
+        }
+        benchKeep(hits);
+    });
+    bench.run("map/isHazard", BenchRunner::UNIT_NS, 50, ops, [&] {
+        long long hits = 0;
+        for (const SDL_Point& p : points) {
+            hits += map.isHazard(p.x, p.y);
+        }
+        benchKeep(hits);
+    });
+    bench.run("map/getCoinPositions", BenchRunner::UNIT_NS, 50, 1, [&] {
+        benchKeep((long long)map.getCoinPositions().size());
+    });
+}
+
+// 玩家不碰到任何金币时每帧的遍历开销（游戏里绝大多数帧都是这种情况）
+void benchCoins(BenchRunner& bench, TiledMap& map) {
+    const int counts[] = {10, 1000, 100000};
+    for (int count : counts) {
+        std::string name = "coins/updateOnPlayerCollision/" + std::to_string(count);
+        if (!bench.isEnabled(name)) {
+            continue;
+        }
+        std::vector<SDL_FPoint> positions;
+        positions.reserve(count);
+        const int columns = std::max(1, map.getContentPixelWidth() / 16);
+        for (int i = 0; i < count; ++i) {
+            positions.push_back({(float)(i % columns) * 16.0f, (float)(i / columns % 64) * 16.0f});
+        }
+        CoinManager coins;
+        coins.spawnFixed(positions, 16);
+
+        const SDL_Rect playerRect = {-1000, -1000, 16, 24};
+        const int ops = std::max(10, 1000000 / count);
+        int score = 0;
+        bench.run(name, BenchRunner::UNIT_NS, 30, ops, [&] {
+            for (int i = 0; i < ops; ++i) {
+                benchKeep(coins.updateOnPlayerCollision(playerRect, map, score));
+            }
+        });
+        coins.clear();
+    }
+}
+
+// 软件渲染器上绘制 back + main 两层，相机从左到右扫过整张地图
+void benchTileRender(BenchRunner& bench, TiledMap& map, SDL_Renderer* softRenderer) {
+    Camera camera(SCREEN_WIDTH, SCREEN_HEIGHT, map.getContentPixelWidth(), map.getContentPixelHeight());
+    const int positions = 16;
+    const float maxX = (float)std::max(0, map.getContentPixelWidth() - SCREEN_WIDTH);
+    const float maxY = (float)std::max(0, map.getContentPixelHeight() - SCREEN_HEIGHT);
+
+    const TiledMap::TileRenderMode modes[] = {TiledMap::TILE_RENDER_PER_TILE, TiledMap::TILE_RENDER_CHUNKED,
+                                              TiledMap::TILE_RENDER_BATCHED};
+    for (TiledMap::TileRenderMode mode : modes) {
+        std::string name = std::string("render/tiles/") + TiledMap::getTileRenderModeName(mode);
+        if (!bench.isEnabled(name)) {
+            continue;
+        }
+        map.setTileRenderMode(mode);
+        bench.run(name, BenchRunner::UNIT_MS, 20, positions, [&] {
+            for (int i = 0; i < positions; ++i) {
+                camera.x = maxX * i / (positions - 1);
+                camera.y = maxY * 0.5f;
+                SDL_SetRenderDrawColor(softRenderer, 0, 0, 0, 255);
+                SDL_RenderClear(softRenderer);
+                map.renderTiles(softRenderer, camera);
+            }
+        });
+    }
+    map.setTileRenderMode(TiledMap::TILE_RENDER_PER_TILE);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Log::init();
+
+    BenchOptions options;
+    options.frameOptions.baselinePath = std::string(ECHOGIDGE_BENCH_BASELINE_DIR) + "/level1_frames.json";
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--map=", 6) == 0) {
+            options.mapPath = argv[i] + 6;
+        } else if (std::strncmp(argv[i], "--filter=", 9) == 0) {
+            options.filter = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--json=", 7) == 0) {
+            options.jsonPath = argv[i] + 7;
+        } else if (std::strncmp(argv[i], "--csv=", 6) == 0) {
+            options.csvPath = argv[i] + 6;
+        } else if (std::strcmp(argv[i], "--frames") == 0) {
+            options.frames = true;
+        } else if (std::strncmp(argv[i], "--frames=", 9) == 0) {
+            options.frames = true;
+            options.frameOptions.replayPath = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--baseline=", 11) == 0) {
+            options.frameOptions.baselinePath = argv[i] + 11;
+        } else if (std::strcmp(argv[i], "--update-baseline") == 0) {
+            options.frameOptions.updateBaseline = true;
+        } else {
+            LOG_WARN(CAT_PERF, "未知参数: " << argv[i]);
+        }
+    }
+
+    // 被测代码自身的加载/调试日志会干扰计时，只保留 perf 类
+    for (int c = 0; c < Log::CAT_COUNT; ++c) {
+        Log::setCategoryEnabled((Log::Category)c, c == Log::CAT_PERF);
+    }
+
+    // 帧时间回归由 Game 自己创建软件渲染器并负责 SDL 的初始化和退出
+    if (options.frames) {
+        BenchRunner bench(options.filter);
+        bool passed = FrameRegression::run(options.frameOptions, bench);
+        passed = writeResults(bench, options) && passed;
+        Log::shutdown();
+        return passed ? 0 : 1;
+    }
+
+    if (IMG_Init(IMG_INIT_PNG) == 0) {
+        LOG_ERROR(CAT_PERF, "SDL_image 初始化失败: " << IMG_GetError());
+        Log::shutdown();
+        return 1;
+    }
+    SDL_Surface* target = SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32,
+                                                         SDL_PIXELFORMAT_RGBA8888);
+    SDL_Renderer* softRenderer = target ? SDL_CreateSoftwareRenderer(target) : nullptr;
+    if (!softRenderer) {
+        LOG_ERROR(CAT_PERF, "软件渲染器创建失败: " << SDL_GetError());
+        SDL_FreeSurface(target);
+        IMG_Quit();
+        Log::shutdown();
+        return 1;
+    }
+
+    int exitCode = 0;
+    try {
+        BenchRunner bench(options.filter);
+        benchMapLoad(bench, options, softRenderer);
+        {
+            TiledMap headlessMap(options.mapPath, nullptr);
+            benchMapQueries(bench, headlessMap);
+            benchCoins(bench, headlessMap);
+        }
+        {
+            TiledMap map(options.mapPath, softRenderer);
+            benchTileRender(bench, map, softRenderer);
+        }
+
+        if (!writeResults(bench, options)) {
+            exitCode = 1;
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR(CAT_PERF, "基准测试失败: " << e.what());
+        exitCode = 1;
+    }
+
+    TextureAtlas::releaseRenderer(softRenderer);
+    TextureCache::releaseRenderer(softRenderer);
+    SDL_DestroyRenderer(softRenderer);
+    SDL_FreeSurface(target);
+    IMG_Quit();
+    Log::shutdown();
+    return exitCode;
+}
@@ -1,19 +1,23 @@
 #include "AudioManager.h"
+#include "Log.h"
 
-AudioManager::AudioManager() {
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
-        std::cerr << "SDL_mixer初始化失败: " << Mix_GetError() << std::endl;
-    } else {
-        initialized = true;
-        std::cout << "音频系统初始化成功" << std::endl;
-    }
-}
+AudioManager::AudioManager() {}
 
 AudioManager::~AudioManager() {
     cleanup();
 }
 
+// 打开音频设备放在 init 里，无界面模式不调用 init，所有播放接口都是空操作
 bool AudioManager::init() {
+    if (initialized) {
+        return true;
+    }
+    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
+        LOG_ERROR(CAT_AUDIO, "SDL_mixer初始化失败: " << Mix_GetError());
+    } else {
+        initialized = true;
+        LOG_INFO(CAT_AUDIO, "音频系统初始化成功");
+    }
     return initialized;
 }
 
@@ -28,12 +32,12 @@ void AudioManager::loadSound(const std::string& name, const std::string& filepat
     
     Mix_Chunk* chunk = Mix_LoadWAV(filepath.c_str());
     if (!chunk) {
-        std::cerr << "音效加载有问题" << filepath << ": " << Mix_GetError() << std::endl;
+        LOG_ERROR(CAT_AUDIO, "音效加载有问题" << filepath << ": " << Mix_GetError());
         return;
     }
     
     sounds[name] = chunk;
-    std::cout << "加载音效：" << name << " (" << filepath << ")" << std::endl;
+    LOG_INFO(CAT_AUDIO, "加载音效：" << name << " (" << filepath << ")");
 }
 
 void AudioManager::playSound(const std::string& name) {
@@ -85,13 +89,13 @@ void AudioManager::playMusic(const std::string& filepath, int loops) {
     
     currentMusic = Mix_LoadMUS(filepath.c_str());
     if (!currentMusic) {
-        std::cerr << "无法加载音乐" << filepath << ": " << Mix_GetError() << std::endl;
+        LOG_ERROR(CAT_AUDIO, "无法加载音乐" << filepath << ": " << Mix_GetError());
         return;
     }
     if (Mix_PlayMusic(currentMusic, loops) == -1) {
-        std::cerr << "放音乐失败: " << Mix_GetError() << std::endl;
+        LOG_ERROR(CAT_AUDIO, "放音乐失败: " << Mix_GetError());
     } else {
-        std::cout << "开始放音乐: " << filepath << std::endl;
+        LOG_INFO(CAT_AUDIO, "开始放音乐: " << filepath);
     }
 }
 
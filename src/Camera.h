@@ -2,15 +2,15 @@
 #include <SDL2/SDL.h>
 #include <glm/glm.hpp>
 #include <algorithm>
-#include <iostream>
+#include "Log.h"
 
 class Camera {
 public:
     Camera(int screenW, int screenH, int mapPixelW, int mapPixelH)
         : screenWidth(screenW), screenHeight(screenH),
           mapPixelWidth(mapPixelW), mapPixelHeight(mapPixelH) {
-        std::cout << "初始化相机 - 屏幕:" << screenW << "x" << screenH 
-                  << ", 地图:" << mapPixelW << "x" << mapPixelH << std::endl;
+        LOG_INFO(CAT_CAMERA, "初始化相机 - 屏幕:" << screenW << "x" << screenH 
+                             << ", 地图:" << mapPixelW << "x" << mapPixelH);
     }
 
     // 跟随玩家（使玩家居中，限制在地图内）
@@ -40,17 +40,10 @@ public:
 
         static int debugCount = 0;
         if (debugCount++ % 180 == 0) {
-            std::cout << "=== 相机跟随 ==================================================" << std::endl;
-            std::cout << "玩家位置: (" << playerPos.x << ", " << playerPos.y << ")" << std::endl;
-            std::cout << "玩家中心: (" << playerCenter.x << ", " << playerCenter.y << ")" << std::endl;
-            std::cout << "相机目标: (" << targetX << ", " << targetY << ")" << std::endl;
-            std::cout << "相机限制: X[" << minX << "~" << maxX << "], Y[" << minY << "~" << maxY << "]" << std::endl;
-            std::cout << "相机最终: (" << x << ", " << y << ")" << std::endl;
-            std::cout << "地图尺寸: " << mapPixelWidth << "x" << mapPixelHeight << std::endl;
-            std::cout << "屏幕尺寸: " << screenWidth << "x" << screenHeight << std::endl;
-            std::cout << "=====================================================" << std::endl;
-            std::cout << "=====================================================" << std::endl;
-
+            LOG_TRACE(CAT_CAMERA, "相机跟随 玩家(" << playerPos.x << ", " << playerPos.y << ") 中心("
+                                  << playerCenter.x << ", " << playerCenter.y << ") 目标(" << targetX << ", "
+                                  << targetY << ") 最终(" << x << ", " << y << ") 限制 X[" << minX << "~" << maxX
+                                  << "] Y[" << minY << "~" << maxY << "]");
         }
     }
 
@@ -1,7 +1,10 @@
 #include "Coin.hpp"
 #include "Camera.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include "TextureAtlas.h"
+#include "TextureCache.h"
 #include "TiledMap.h"
-#include <SDL2/SDL_image.h>
 #include <algorithm>
 #include <cmath>
 
@@ -11,8 +14,9 @@ static inline bool Intersects(const SDL_Rect& a, const SDL_Rect& b) {
 }
 
 bool CoinManager::load(SDL_Renderer* renderer, const char* path) {
-    coinTex_ = IMG_LoadTexture(renderer, path);
-    return coinTex_ != nullptr;
+    TextureCache::release(coinSprite_.texture);
+    coinSprite_ = TextureRegion();
+    return TextureAtlas::acquire(renderer, path, coinSprite_);
 }
 
 void CoinManager::spawnFixed(const std::vector<SDL_FPoint>& pts, int size) {
@@ -23,6 +27,7 @@ void CoinManager::spawnFixed(const std::vector<SDL_FPoint>& pts, int size) {
             true
         });
     }
+    spawned_ = coins_;
 }
 
 // 修改：返回bool表示是否有金币被收集
@@ -46,7 +51,8 @@ bool CoinManager::updateOnPlayerCollision(const SDL_Rect& playerRect, TiledMap&
 }
 
 void CoinManager::render(SDL_Renderer* renderer, const Camera& cam, float renderScale) const {
-    if (!coinTex_) return;
+    PROFILE_SCOPE("CoinManager::render");
+    if (!coinSprite_.texture) return;
 
     const int camX = (int)std::lround(cam.x);
     const int camY = (int)std::lround(cam.y);
@@ -60,11 +66,17 @@ void CoinManager::render(SDL_Renderer* renderer, const Camera& cam, float render
         dst.w = (int)std::lround(c.rect.w * renderScale);
         dst.h = (int)std::lround(c.rect.h * renderScale);
 
-        SDL_RenderCopy(renderer, coinTex_, nullptr, &dst);
+        RenderStats::copy(renderer, coinSprite_.texture, &coinSprite_.src, &dst);
     }
 }
 
+void CoinManager::reset() {
+    coins_.assign(spawned_.begin(), spawned_.end());  // 容量还在，不重新分配
+}
+
 void CoinManager::clear() {
     coins_.clear();
-    if (coinTex_) { SDL_DestroyTexture(coinTex_); coinTex_ = nullptr; }
+    spawned_.clear();
+    TextureCache::release(coinSprite_.texture);
+    coinSprite_ = TextureRegion();
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include <SDL2/SDL.h>
+#include "TextureAtlas.h"
 #include <vector>
 
 class Camera;
@@ -12,12 +13,14 @@ struct Coin {
 
 class CoinManager {
 public:
-    bool load(SDL_Renderer* renderer, const char* path);
+    bool load(SDL_Renderer* renderer, const char* path);  // 金币图片打包进图集，和地图瓦片共用图集页
     void spawnFixed(const std::vector<SDL_FPoint>& pts, int size);
     bool updateOnPlayerCollision(const SDL_Rect& playerRect, TiledMap& map, int& score); // 修改：返回bool
     void render(SDL_Renderer* renderer, const Camera& cam, float renderScale) const;
+    void reset();  // 恢复到 spawnFixed 之后的金币列表（新游戏复用，纹理保留）
     void clear();
 private:
     std::vector<Coin> coins_;
-    SDL_Texture* coinTex_ = nullptr;
+    std::vector<Coin> spawned_;  // spawnFixed 生成的原始列表
+    TextureRegion coinSprite_;
 };
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+
+// .egmap：TiledMap 的编译地图格式，由 EchoGidgeMapC 从 .tmj 生成。
+// 文件布局：Header | 瓦片集表 | items 表 | 图像图层表 | GID 标记表 | back 层 | main 层 | 格子标记 | 字符串表。
+// 小端序，每段按 8 字节对齐；运行时 mmap 后瓦片层和格子标记直接当数组使用，不做任何解析。
+// 字符串存为字符串表里的偏移（以 0 结尾），NO_STRING 表示没有。
+namespace CompiledMap {
+    const uint32_t MAGIC = 0x504D4745u;  // 文件开头的 "EGMP"
+    const uint32_t VERSION = 1;
+    const uint32_t NO_STRING = 0xFFFFFFFFu;
+    const uint64_t ALIGNMENT = 8;
+
+    inline uint64_t alignUp(uint64_t value) { return (value + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+    // 瓦片网格：width * height 个格子，按行存储
+    struct GridSection {
+        int32_t width;
+        int32_t height;
+        uint64_t offset;
+    };
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t headerSize;  // sizeof(Header)，防止编译器之间结构体布局不一致
+        uint32_t cellBits;    // back/main 层每格位数（16 或 32），与 TileGrid 一致时原地使用，否则加载时转换
+        int32_t tileWidth;
+        int32_t tileHeight;
+        int32_t mapWidth;
+        int32_t mapHeight;
+        int32_t coinFirstGid;  // 没有 coin 瓦片集时为 -1
+        int32_t coinTileCount;
+        uint32_t tilesetCount;
+        uint32_t itemCount;
+        uint32_t imageLayerCount;
+        uint32_t gidFlagCount;
+        uint64_t tilesetOffset;
+        uint64_t itemOffset;
+        uint64_t imageLayerOffset;
+        uint64_t gidFlagOffset;  // 每个 GID 一个字节的 TiledMap::TileFlags
+        GridSection backLayer;
+        GridSection mainLayer;
+        GridSection cellFlags;   // 每格一个字节，与运行时 TiledMap::cellFlags 相同
+        uint64_t stringOffset;
+        uint64_t stringSize;
+        uint64_t fileSize;       // 用于发现被截断的文件
+    };
+
+    struct TilesetEntry {
+        int32_t firstGid;
+        uint32_t name;
+        uint32_t image;  // 相对 assets/ 的路径，没有整张图片的瓦片集为 NO_STRING
+    };
+
+    struct ItemEntry {
+        int32_t gid;
+        int32_t width;
+        int32_t height;
+        uint32_t image;
+    };
+
+    struct ImageLayerEntry {
+        uint32_t name;
+        uint32_t image;
+        int32_t x;
+        int32_t y;
+        int32_t offsetX;
+        int32_t offsetY;
+        int32_t imageWidth;   // 0 表示加载纹理后再查询
+        int32_t imageHeight;
+        float opacity;
+        float parallaxX;
+        uint32_t repeatX;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(GridSection) == 16, "GridSection layout");
+    static_assert(sizeof(Header) == 160, "Header layout");
+    static_assert(sizeof(TilesetEntry) == 12, "TilesetEntry layout");
+    static_assert(sizeof(ItemEntry) == 16, "ItemEntry layout");
+    static_assert(sizeof(ImageLayerEntry) == 48, "ImageLayerEntry layout");
+}
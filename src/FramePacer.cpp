@@ -0,0 +1,120 @@
+#include "FramePacer.h"
+#include "Log.h"
+#include <SDL2/SDL_atomic.h>
+#include <algorithm>
+
+const int FramePacer::INTERVAL_HISTORY;  // 传给 std::min（引用参数）时需要定义
+
+FramePacer::FramePacer() : intervalsMs(INTERVAL_HISTORY, 0.0f) {
+    frequency = SDL_GetPerformanceFrequency();
+    // SDL_Delay 的实际精度在 1~2ms，留 2ms 自旋
+    spinThreshold = frequency * 2 / 1000;
+    lastFrameCounter = SDL_GetPerformanceCounter();
+    nextDeadline = lastFrameCounter;
+}
+
+const char* FramePacer::getModeName(Mode mode) {
+    switch (mode) {
+        case MODE_VSYNC: return "vsync";
+        case MODE_CAPPED: return "capped";
+        case MODE_UNCAPPED: return "uncapped";
+    }
+    return "unknown";
+}
+
+void FramePacer::configure(Mode newMode, int hz, SDL_Renderer* renderer) {
+    mode = newMode;
+    targetHz = std::max(1, hz);
+    framePeriod = frequency / targetHz;
+
+    if (renderer) {
+        if (SDL_RenderSetVSync(renderer, mode == MODE_VSYNC ? 1 : 0) != 0) {
+            LOG_WARN(CAT_PERF, "设置垂直同步失败: " << SDL_GetError());
+        }
+    }
+
+    if (mode == MODE_CAPPED) {
+        LOG_INFO(CAT_PERF, "帧节奏模式: " << getModeName(mode) << " " << targetHz << " Hz");
+    } else {
+        LOG_INFO(CAT_PERF, "帧节奏模式: " << getModeName(mode));
+    }
+
+    resync();
+    resetStats();
+}
+
+void FramePacer::resync() {
+    lastFrameCounter = SDL_GetPerformanceCounter();
+    nextDeadline = lastFrameCounter + framePeriod;
+    skipNextSample = true;
+}
+
+void FramePacer::waitUntil(Uint64 deadline) const {
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (now >= deadline) {
+        return;
+    }
+    Uint64 remaining = deadline - now;
+    if (remaining > spinThreshold) {
+        Uint32 sleepMs = (Uint32)((remaining - spinThreshold) * 1000 / frequency);
+        if (sleepMs > 0) {
+            SDL_Delay(sleepMs);
+        }
+    }
+    while (SDL_GetPerformanceCounter() < deadline) {
+        SDL_CPUPauseInstruction();
+    }
+}
+
+void FramePacer::endFrame() {
+    if (mode == MODE_CAPPED) {
+        waitUntil(nextDeadline);
+        Uint64 now = SDL_GetPerformanceCounter();
+        // 按截止时间累加而不是按 now 累加，长期平均帧率才准确；落后超过一帧则重新对齐
+        nextDeadline += framePeriod;
+        if (now > nextDeadline) {
+            nextDeadline = now + framePeriod;
+        }
+    }
+
+    Uint64 now = SDL_GetPerformanceCounter();
+    double seconds = (double)(now - lastFrameCounter) / frequency;
+    lastFrameCounter = now;
+
+    if (skipNextSample) {
+        skipNextSample = false;
+        lastFrameSeconds = mode == MODE_CAPPED ? 1.0 / targetHz : 1.0 / 60.0;
+        return;
+    }
+    lastFrameSeconds = seconds;
+    recordInterval(seconds * 1000.0);
+}
+
+void FramePacer::recordInterval(double ms) {
+    intervalsMs[intervalIndex] = (float)ms;
+    intervalIndex = (intervalIndex + 1) % INTERVAL_HISTORY;
+    intervalCount = std::min(intervalCount + 1, INTERVAL_HISTORY);
+}
+
+FramePacer::Stats FramePacer::computeStats() const {
+    Stats stats;
+    if (intervalCount == 0) {
+        return stats;
+    }
+    std::vector<float> sorted(intervalsMs.begin(), intervalsMs.begin() + intervalCount);
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](double p) {
+        size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+        return (double)sorted[index];
+    };
+    stats.p50Ms = percentile(0.50);
+    stats.p99Ms = percentile(0.99);
+    stats.maxMs = sorted.back();
+    stats.samples = intervalCount;
+    return stats;
+}
+
+void FramePacer::resetStats() {
+    intervalIndex = 0;
+    intervalCount = 0;
+}
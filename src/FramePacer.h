@@ -0,0 +1,58 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <vector>
+
+// 基于 SDL_GetPerformanceCounter 的帧节奏控制：
+// 垂直同步模式只测量不等待；限帧模式先 SDL_Delay 睡到截止时间前一点，再自旋到截止时间；
+// 不限帧模式用于性能测试。同时记录最近若干帧的帧间隔，统计 p50/p99 抖动。
+class FramePacer {
+public:
+    enum Mode {
+        MODE_VSYNC,
+        MODE_CAPPED,
+        MODE_UNCAPPED
+    };
+
+    struct Stats {
+        double p50Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+        int samples = 0;
+    };
+
+    FramePacer();
+
+    // renderer 可为空；非空时同步打开/关闭渲染器的垂直同步，避免和限帧双重限速
+    void configure(Mode mode, int targetHz, SDL_Renderer* renderer);
+    Mode getMode() const { return mode; }
+    int getTargetHz() const { return targetHz; }
+    static const char* getModeName(Mode mode);
+
+    // 每帧 Present 之后调用一次：按模式等待到下一帧，并记录本帧间隔
+    void endFrame();
+    // 长时间阻塞（菜单、加载）之后调用，下一帧不计入统计，也不补偿
+    void resync();
+    double getLastFrameSeconds() const { return lastFrameSeconds; }
+
+    Stats computeStats() const;
+    void resetStats();
+
+private:
+    void waitUntil(Uint64 deadline) const;
+    void recordInterval(double ms);
+
+    Mode mode = MODE_VSYNC;
+    int targetHz = 60;
+    Uint64 frequency = 1;
+    Uint64 framePeriod = 0;    // 限帧模式下一帧的计数器刻度
+    Uint64 spinThreshold = 0;  // 距截止时间小于此值时改为自旋
+    Uint64 lastFrameCounter = 0;
+    Uint64 nextDeadline = 0;
+    double lastFrameSeconds = 1.0 / 60.0;
+    bool skipNextSample = true;
+
+    static const int INTERVAL_HISTORY = 512;
+    std::vector<float> intervalsMs;
+    int intervalIndex = 0;
+    int intervalCount = 0;
+};
@@ -1,12 +1,23 @@
 #include "Game.h"
-
-#include <iostream>
+#include "Log.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include "TextureAtlas.h"
+#include "TextureCache.h"
+
+#include <algorithm>
+#include <cmath>
 #include <string>
 
 Game::Game() : deathImage(nullptr), winImage(nullptr) {}
 
+Game::Game(const GameOptions& options) : options(options), deathImage(nullptr), winImage(nullptr) {
+    TextureCache::setBudget((size_t)std::max(options.textureBudgetMB, 1) << 20);
+}
+
 Game::~Game() {
     cleanupHudText();
+    perfOverlay.cleanup();
     if (hudFont) {
         TTF_CloseFont(hudFont);
         hudFont = nullptr;
@@ -15,10 +26,22 @@ Game::~Game() {
     delete player;
     delete camera;
     delete startMenu;
+    TextureCache::release(playerSprite.texture);
     cleanupDeathImage();
     cleanupWinImage();
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
+    if (renderer) {
+        TextureAtlas::logReport();
+        TextureCache::logReport();
+        TextureAtlas::releaseRenderer(renderer);
+        TextureCache::releaseRenderer(renderer);
+        SDL_DestroyRenderer(renderer);
+    }
+    if (softwareTarget) {
+        SDL_FreeSurface(softwareTarget);
+    }
+    if (window) {
+        SDL_DestroyWindow(window);
+    }
     IMG_Quit();
     Mix_Quit();
     SDL_Quit();
@@ -26,21 +49,21 @@ Game::~Game() {
 
 bool Game::init() {
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
-        std::cerr << "SDL 初始化失败: " << SDL_GetError() << std::endl;
+        LOG_ERROR(CAT_GAME, "SDL 初始化失败: " << SDL_GetError());
         return false;
     }
 
     window = SDL_CreateWindow(
         "EchoRidge", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, 0);
     if (!window) {
-        std::cerr << "创建窗口失败: " << SDL_GetError() << std::endl;
+        LOG_ERROR(CAT_GAME, "创建窗口失败: " << SDL_GetError());
         SDL_Quit();
         return false;
     }
 
     renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
     if (!renderer) {
-        std::cerr << "创建渲染器失败: " << SDL_GetError() << std::endl;
+        LOG_ERROR(CAT_GAME, "创建渲染器失败: " << SDL_GetError());
         SDL_DestroyWindow(window);
         SDL_Quit();
         return false;
@@ -49,7 +72,7 @@ bool Game::init() {
     SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);
 
     if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
-        std::cerr << "SDL_image 初始化失败: " << IMG_GetError() << std::endl;
+        LOG_ERROR(CAT_GAME, "SDL_image 初始化失败: " << IMG_GetError());
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
         SDL_Quit();
@@ -57,29 +80,48 @@ bool Game::init() {
     }
 
     if (!audioManager.init()) {
-        std::cerr << "音频系统初始化失败" << std::endl;
+        LOG_ERROR(CAT_GAME, "音频系统初始化失败");
     } else {
         loadAllSounds();
     }
 
+    initHudFont();  // 加载画面也要用
+
+    // 菜单背景、死亡/通关画面和玩家纹理在工作线程并行解码，这里边显示进度边上传。
+    // 每张图按它最大的绘制尺寸降采样：死亡/通关画面最多占屏幕的 80%，菜单背景铺满窗口，玩家按 renderScale 绘制
+    const float outputScale = getOutputScale();
+    const TextureCache::Lod overlayLod =
+        TextureCache::Lod::fit((int)std::ceil(SCREEN_WIDTH * OVERLAY_IMAGE_SCALE * outputScale),
+                               (int)std::ceil(SCREEN_HEIGHT * OVERLAY_IMAGE_SCALE * outputScale));
+    const TextureCache::Lod playerLod =
+        TextureCache::Lod::stretch((int)std::ceil(Player::DRAW_WIDTH * RENDER_SCALE * outputScale),
+                                   (int)std::ceil(Player::DRAW_HEIGHT * RENDER_SCALE * outputScale));
+    ImageLoader images;
+    const int menuBackground = images.add(StartMenu::BACKGROUND_PATH, StartMenu::backgroundLod(renderer));
+    const int deathIndex = images.add("assets/animations/you_die.png", overlayLod);
+    const int winIndex = images.add("assets/animations/you_win.png", overlayLod);
+    const int playerIndex = images.addPacked(Player::TEXTURE_PATH, playerLod);
+    renderLoadingScreen("加载中", 0, images.getCount());
+    images.load(renderer, [this](int done, int total) { renderLoadingScreen("加载中", done, total); });
+
     startMenu = new StartMenu(renderer);
-    if (!startMenu->init()) {
-        std::cerr << "开始菜单初始化失败" << std::endl;
+    if (!startMenu->init(images.takeTexture(menuBackground))) {
+        LOG_ERROR(CAT_GAME, "开始菜单初始化失败");
     }
 
-    if (!loadDeathImage()) {
-        std::cerr << "死亡图片加载失败，使用纯色背景替代" << std::endl;
+    if (!loadDeathImage(images, deathIndex)) {
+        LOG_WARN(CAT_GAME, "死亡图片加载失败，使用纯色背景替代");
     }
 
-    if (!loadWinImage()) {
-        std::cerr << "通关图片加载失败，使用纯色背景替代" << std::endl;
+    if (!loadWinImage(images, winIndex)) {
+        LOG_WARN(CAT_GAME, "通关图片加载失败，使用纯色背景替代");
     }
+    playerSprite = images.takeRegion(playerIndex);
 
     gameState = STATE_MENU;
-    lastUpdateTime = SDL_GetTicks();
-    std::cout << "时间系统初始化完成 LastUpdateTime: " << lastUpdateTime << std::endl;
+    // 帧节奏由 FramePacer 统一控制，渲染器的垂直同步按模式打开或关闭
+    pacer.configure(options.frameMode, options.targetFps, renderer);
 
-    initHudFont();
     isRunning = true;
     return true;
 }
@@ -99,7 +141,7 @@ void Game::loadAllSounds() {
     audioManager.setVolume("die", 110);
     audioManager.setVolume("win", 110);
 
-    std::cout << "音频加载完成，跳跃/受伤音量 120，背景音乐 50" << std::endl;
+    LOG_INFO(CAT_GAME, "音频加载完成，跳跃/受伤音量 120，背景音乐 50");
 }
 
 void Game::startMenuMusic() {
@@ -108,7 +150,7 @@ void Game::startMenuMusic() {
         audioManager.playMusic("assets/sounds/begining.wav", -1);
         menuMusicStarted = true;
         gameMusicStarted = false;
-        std::cout << "开始播放菜单音乐 (begining.wav)" << std::endl;
+        LOG_INFO(CAT_GAME, "开始播放菜单音乐 (begining.wav)");
     }
 }
 
@@ -118,7 +160,7 @@ void Game::startGameMusic() {
         audioManager.playMusic("assets/sounds/main.wav", -1);
         gameMusicStarted = true;
         menuMusicStarted = false;
-        std::cout << "开始播放游戏音乐 (main.wav)" << std::endl;
+        LOG_INFO(CAT_GAME, "开始播放游戏音乐 (main.wav)");
     }
 }
 
@@ -133,53 +175,91 @@ void Game::runMenuState() {
         startMenuMusic();
     }
 
-    if (startMenu) {
+    int choice = 0;
+    if (isReplaying()) {
+        const ReplayPlayer::Record* record = replayer.peek();
+        if (!record || record->type != REPLAY_MENU) {
+            LOG_INFO(CAT_REPLAY, "回放结束");
+            isRunning = false;
+            return;
+        }
+        choice = record->value;
+        replayer.consume();
+        LOG_INFO(CAT_REPLAY, "回放菜单选择: " << choice);
+    } else if (startMenu) {
         startMenu->reset();
-        int choice = startMenu->run();
-
-        switch (choice) {
-            case 0:
-                std::cout << "开始新游戏" << std::endl;
+        choice = startMenu->run();
+    } else {
+        LOG_INFO(CAT_GAME, "菜单不可用，直接开始游戏");
+    }
+    recorder.recordMenuChoice(choice);
+
+    switch (choice) {
+        case 0:
+            LOG_INFO(CAT_GAME, "开始新游戏");
+            startGameMusic();
+            startNewGame();
+            gameState = STATE_PLAYING;
+            break;
+        case 1:
+            LOG_INFO(CAT_GAME, "继续游戏");
+            if (map && player && camera) {
+                startGameMusic();
+                resetSimulationClock();
+                gameState = STATE_PLAYING;
+            } else {
                 startGameMusic();
                 startNewGame();
                 gameState = STATE_PLAYING;
-                break;
-            case 1:
-                std::cout << "继续游戏" << std::endl;
-                if (map && player && camera) {
-                    startGameMusic();
-                    gameState = STATE_PLAYING;
-                } else {
-                    startGameMusic();
-                    startNewGame();
-                    gameState = STATE_PLAYING;
-                }
-                break;
-            case 2:
-                std::cout << "退出游戏" << std::endl;
-                isRunning = false;
-                break;
-        }
-    } else {
-        std::cout << "菜单不可用，直接开始游戏" << std::endl;
-        startGameMusic();
-        startNewGame();
-        gameState = STATE_PLAYING;
+            }
+            break;
+        case 2:
+            LOG_INFO(CAT_GAME, "退出游戏");
+            isRunning = false;
+            break;
     }
 }
 
+void Game::returnToMenu() {
+    gameState = STATE_MENU;
+    LOG_INFO(CAT_GAME, "回到开始菜单");
+    audioManager.stopAll();
+    startMenuMusic();
+}
+
 void Game::handleEvents() {
+    PROFILE_SCOPE("Game::handleEvents");
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
         if (event.type == SDL_QUIT) {
             isRunning = false;
+        } else if (event.type == SDL_RENDER_TARGETS_RESET || event.type == SDL_RENDER_DEVICE_RESET) {
+            // 渲染目标内容丢失，瓦片块缓存需要重新烘焙
+            if (map) {
+                map->invalidateTileCache();
+            }
         } else if (event.type == SDL_KEYDOWN) {
-            if (event.key.keysym.sym == SDLK_ESCAPE) {
+            if (event.key.keysym.sym == SDLK_F2 && map) {
+                // 循环切换：分块缓存 -> 合批 -> 逐瓦片
+                TiledMap::TileRenderMode mode = map->getTileRenderMode();
+                TiledMap::TileRenderMode next =
+                    mode == TiledMap::TILE_RENDER_CHUNKED ? TiledMap::TILE_RENDER_BATCHED :
+                    mode == TiledMap::TILE_RENDER_BATCHED ? TiledMap::TILE_RENDER_PER_TILE :
+                                                            TiledMap::TILE_RENDER_CHUNKED;
+                map->setTileRenderMode(next);
+                LOG_INFO(CAT_GAME, "瓦片渲染方式: " << TiledMap::getTileRenderModeName(next));
+            }
+            if (event.key.keysym.sym == SDLK_F3) {
+                perfOverlay.toggle();
+            }
+            if (event.key.keysym.sym == SDLK_F9) {
+                Profiler::writeChromeTrace(options.tracePath.empty() ? "trace.json" : options.tracePath);
+            }
+            // 回放时 ESC 来自回放文件，忽略实际按键
+            if (event.key.keysym.sym == SDLK_ESCAPE && !isReplaying()) {
                 if (gameState == STATE_PLAYING) {
-                    gameState = STATE_MENU;
-                    std::cout << "回到开始菜单" << std::endl;
-                    audioManager.stopAll();
-                    startMenuMusic();
+                    recorder.recordEsc();
+                    returnToMenu();
                 }
             }
         }
@@ -187,28 +267,94 @@ void Game::handleEvents() {
 }
 
 void Game::runPlayingState() {
+    // 上一帧的帧间隔刚由 FramePacer 测出，和上一帧的更新/渲染耗时一起记入面板
+    PerfOverlay::Sample sample;
+    sample.frameMs = (float)(pacer.getLastFrameSeconds() * 1000.0);
+    sample.updateMs = lastUpdateMs;
+    sample.renderMs = lastRenderMs;
+    perfOverlay.addSample(sample);
+
     handleEvents();
-    update(deltaTime);
+
+    const double counterToMs = 1000.0 / (double)SDL_GetPerformanceFrequency();
+    Uint64 updateStart = SDL_GetPerformanceCounter();
+
+    // 把真实帧时间累积起来，按固定步长推进模拟，与显示刷新率解耦
+    simAccumulator += deltaTime;
+    int steps = 0;
+    while (simAccumulator >= SIM_DT && gameState == STATE_PLAYING && steps < MAX_SIM_STEPS_PER_FRAME) {
+        if (isReplaying() && !applyReplayEvents()) {
+            break;
+        }
+        update(SIM_DT);
+        simAccumulator -= SIM_DT;
+        ++steps;
+    }
+    if (steps == MAX_SIM_STEPS_PER_FRAME) {
+        simAccumulator = 0.0f;  // 追不上时丢弃积压，避免越来越慢
+    }
+    renderAlpha = simAccumulator / SIM_DT;
+    lastSimSteps = steps;
+
+    Uint64 renderStart = SDL_GetPerformanceCounter();
+    lastUpdateMs = (float)((renderStart - updateStart) * counterToMs);
+    lastRenderMs = 0.0f;
+
+    if (gameState != STATE_PLAYING || !isRunning) {
+        return;
+    }
     render();
+    lastRenderMs = (float)((SDL_GetPerformanceCounter() - renderStart) * counterToMs);
+}
 
-    Uint32 frameTime = SDL_GetTicks() - lastUpdateTime;
-    if (frameTime < 16) {
-        SDL_Delay(16 - frameTime);
+// 回放模式下在每个模拟步之前处理排在它前面的事件；返回 false 表示本帧停止模拟
+bool Game::applyReplayEvents() {
+    const ReplayPlayer::Record* record = replayer.peek();
+    if (!record) {
+        LOG_INFO(CAT_REPLAY, "回放结束");
+        isRunning = false;
+        return false;
+    }
+    if (record->type == REPLAY_ESC) {
+        replayer.consume();
+        returnToMenu();
+        return false;
+    }
+    if (record->type != REPLAY_TICK) {
+        LOG_ERROR(CAT_REPLAY, "回放在游戏中遇到菜单记录，停止回放");
+        isRunning = false;
+        return false;
+    }
+    return true;
+}
+
+void Game::resetSimulationClock() {
+    pacer.resync();  // 菜单等阻塞期间的时间不计入模拟
+    simAccumulator = 0.0f;
+    renderAlpha = 1.0f;
+    if (player) {
+        player->savePreviousPosition();
+    }
+    if (camera) {
+        prevCameraX = camera->x;
+        prevCameraY = camera->y;
     }
 }
 
 void Game::update(float delta) {
+    PROFILE_SCOPE("Game::update");
     if (gameState != STATE_PLAYING) {
         return;
     }
 
-    player->handleInput();
+    ++simTickCount;
 
-    player->setAudioCallback([this](const std::string& soundName) {
-        audioManager.playSound(soundName);
-        std::cout << "播放音效: " << soundName << std::endl;
-    });
+    // 记录上一个模拟状态，渲染时在两者之间插值
+    player->savePreviousPosition();
+    prevCameraX = camera->x;
+    prevCameraY = camera->y;
 
+    player->handleInput(nextPlayerInput());
     player->update(*map, delta);
 
     bool coinCollected = coins.updateOnPlayerCollision(player->getWorldRect(), *map, score);
@@ -219,7 +365,7 @@ void Game::update(float delta) {
     camera->follow(player->getPosition(), map->getRenderScale());
 
     if (player->isDead()) {
-        std::cout << "检测到玩家死亡" << std::endl;
+        LOG_INFO(CAT_GAME, "检测到玩家死亡");
         audioManager.playSound("die");
         stopAllMusic();
         handlePlayerDeath();
@@ -235,7 +381,7 @@ void Game::update(float delta) {
     }
 
     if (playerPos.x >= 4600.0f) {
-        std::cout << "玩家到达终点 (" << playerPos.x << ", " << playerPos.y << ")" << std::endl;
+        LOG_INFO(CAT_GAME, "玩家到达终点 (" << playerPos.x << ", " << playerPos.y << ")");
         audioManager.playSound("win");
         stopAllMusic();
         handlePlayerWin();
@@ -250,7 +396,7 @@ void Game::runDeathAnimationState() {
             isRunning = false;
             return;
         } else if (e.type == SDL_KEYDOWN || e.type == SDL_MOUSEBUTTONDOWN) {
-            std::cout << "玩家跳过死亡动画" << std::endl;
+            LOG_INFO(CAT_GAME, "玩家跳过死亡动画");
             gameState = STATE_MENU;
             if (player) {
                 player->respawn();
@@ -266,11 +412,12 @@ void Game::runDeathAnimationState() {
 
     static int debugCount = 0;
     if (debugCount++ % 60 == 0) {
-        std::cout << "死亡动画进度: " << elapsed << "/" << DEATH_DISPLAY_TIME << " ms" << std::endl;
+        LOG_DEBUG(CAT_GAME, "死亡动画进度: " << elapsed << "/" << DEATH_DISPLAY_TIME << " ms");
     }
 
-    if (elapsed >= DEATH_DISPLAY_TIME) {
-        std::cout << "死亡动画播放结束，回到菜单" << std::endl;
+    // 回放不等待动画，直接回到菜单读取下一条记录
+    if (elapsed >= DEATH_DISPLAY_TIME || isReplaying()) {
+        LOG_INFO(CAT_GAME, "死亡动画播放结束，回到菜单");
         gameState = STATE_MENU;
         if (player) {
             player->respawn();
@@ -291,7 +438,7 @@ void Game::runDeathAnimationState() {
         if (imgWidth > SCREEN_WIDTH || imgHeight > SCREEN_HEIGHT) {
             float scaleX = static_cast<float>(SCREEN_WIDTH) / imgWidth;
             float scaleY = static_cast<float>(SCREEN_HEIGHT) / imgHeight;
-            float scale = std::min(scaleX, scaleY) * 0.8f;
+            float scale = std::min(scaleX, scaleY) * OVERLAY_IMAGE_SCALE;
 
             int scaledWidth = static_cast<int>(imgWidth * scale);
             int scaledHeight = static_cast<int>(imgHeight * scale);
@@ -315,7 +462,6 @@ void Game::runDeathAnimationState() {
     }
 
     SDL_RenderPresent(renderer);
-    SDL_Delay(16);
 }
 
 void Game::runWinAnimationState() {
@@ -325,9 +471,9 @@ void Game::runWinAnimationState() {
             isRunning = false;
             return;
         } else if (e.type == SDL_KEYDOWN || e.type == SDL_MOUSEBUTTONDOWN) {
-            std::cout << "玩家跳过通关动画" << std::endl;
+            LOG_INFO(CAT_GAME, "玩家跳过通关动画");
             gameState = STATE_MENU;
-            std::cout << "最终得分 " << score << std::endl;
+            LOG_INFO(CAT_GAME, "最终得分 " << score);
             audioManager.stopAll();
             startMenuMusic();
             return;
@@ -339,12 +485,12 @@ void Game::runWinAnimationState() {
 
     static int debugCount = 0;
     if (debugCount++ % 60 == 0) {
-        std::cout << "通关动画进度: " << elapsed << "/" << WIN_DISPLAY_TIME << " ms" << std::endl;
+        LOG_DEBUG(CAT_GAME, "通关动画进度: " << elapsed << "/" << WIN_DISPLAY_TIME << " ms");
     }
 
-    if (elapsed >= WIN_DISPLAY_TIME) {
-        std::cout << "通关动画播放结束，回到菜单" << std::endl;
-        std::cout << "最终得分 " << score << std::endl;
+    if (elapsed >= WIN_DISPLAY_TIME || isReplaying()) {
+        LOG_INFO(CAT_GAME, "通关动画播放结束，回到菜单");
+        LOG_INFO(CAT_GAME, "最终得分 " << score);
         gameState = STATE_MENU;
         audioManager.stopAll();
         startMenuMusic();
@@ -362,7 +508,7 @@ void Game::runWinAnimationState() {
         if (imgWidth > SCREEN_WIDTH || imgHeight > SCREEN_HEIGHT) {
             float scaleX = static_cast<float>(SCREEN_WIDTH) / imgWidth;
             float scaleY = static_cast<float>(SCREEN_HEIGHT) / imgHeight;
-            float scale = std::min(scaleX, scaleY) * 0.8f;
+            float scale = std::min(scaleX, scaleY) * OVERLAY_IMAGE_SCALE;
 
             int scaledWidth = static_cast<int>(imgWidth * scale);
             int scaledHeight = static_cast<int>(imgHeight * scale);
@@ -386,16 +532,15 @@ void Game::runWinAnimationState() {
     }
 
     SDL_RenderPresent(renderer);
-    SDL_Delay(16);
 }
 
 void Game::handlePlayerWin() {
-    std::cout << "玩家通关！恭喜" << std::endl;
-    std::cout << "最终得分 " << score << std::endl;
+    LOG_INFO(CAT_GAME, "玩家通关！恭喜");
+    LOG_INFO(CAT_GAME, "最终得分 " << score);
 
     winStartTime = SDL_GetTicks();
     gameState = STATE_WIN_ANIMATION;
-    std::cout << "切换到 STATE_WIN_ANIMATION" << std::endl;
+    LOG_INFO(CAT_GAME, "切换到 STATE_WIN_ANIMATION");
 }
 
 bool Game::initHudFont() {
@@ -404,7 +549,7 @@ bool Game::initHudFont() {
     }
     if (TTF_WasInit() == 0) {
         if (TTF_Init() == -1) {
-            std::cerr << "字体初始化失败: " << TTF_GetError() << std::endl;
+            LOG_ERROR(CAT_GAME, "字体初始化失败: " << TTF_GetError());
             return false;
         }
     }
@@ -413,7 +558,7 @@ bool Game::initHudFont() {
         hudFont = TTF_OpenFont("arial.ttf", 20);
     }
     if (!hudFont) {
-        std::cerr << "字体加载失败: " << TTF_GetError() << std::endl;
+        LOG_ERROR(CAT_GAME, "字体加载失败: " << TTF_GetError());
         return false;
     }
     return true;
@@ -436,7 +581,7 @@ void Game::updateScoreTexture() {
     SDL_Color color{255, 215, 0, 255};
     SDL_Surface* surface = TTF_RenderUTF8_Blended(hudFont, text.c_str(), color);
     if (!surface) {
-        std::cerr << "HUD文本表面创建失败: " << TTF_GetError() << std::endl;
+        LOG_ERROR(CAT_GAME, "HUD文本表面创建失败: " << TTF_GetError());
         return;
     }
     scoreTexture = SDL_CreateTextureFromSurface(renderer, surface);
@@ -444,7 +589,7 @@ void Game::updateScoreTexture() {
     scoreTexH = surface->h;
     SDL_FreeSurface(surface);
     if (!scoreTexture) {
-        std::cerr << "HUD文本纹理创建失败: " << SDL_GetError() << std::endl;
+        LOG_ERROR(CAT_GAME, "HUD文本纹理创建失败: " << SDL_GetError());
         return;
     }
     lastScoreRendered = score;
@@ -466,7 +611,7 @@ void Game::renderHud() {
         dest.x = 0;
     }
     dest.y = 8;
-    SDL_RenderCopy(renderer, scoreTexture, nullptr, &dest);
+    RenderStats::copy(renderer, scoreTexture, nullptr, &dest);
 }
 
 void Game::cleanupHudText() {
@@ -477,147 +622,477 @@ void Game::cleanupHudText() {
 }
 
 void Game::handlePlayerDeath() {
-    std::cout << "处理玩家死亡" << std::endl;
+    LOG_INFO(CAT_GAME, "处理玩家死亡");
 
     if (player && player->isDead()) {
-        std::cout << "玩家死亡，进入死亡动画" << std::endl;
+        LOG_INFO(CAT_GAME, "玩家死亡，进入死亡动画");
         deathStartTime = SDL_GetTicks();
         gameState = STATE_DEATH_ANIMATION;
-        std::cout << "切换到 STATE_DEATH_ANIMATION" << std::endl;
+        LOG_INFO(CAT_GAME, "切换到 STATE_DEATH_ANIMATION");
     }
 }
 
 void Game::startNewGame() {
-    if (map) {
-        delete map;
-        map = nullptr;
-    }
-    if (player) {
-        delete player;
-        player = nullptr;
-    }
-    if (camera) {
-        delete camera;
-        camera = nullptr;
-    }
-
     score = 0;
     lastScoreRendered = -1;
     cleanupHudText();
 
+    const float startX = 100.0f;
+    const float startY = 100.0f;
+
+    // 关卡常驻：地图、纹理、玩家和相机只在第一局创建，之后的新游戏只还原被改动的状态
+    if (map && player && camera) {
+        PROFILE_SCOPE("Game::restartLevel");
+        const uint64_t startTicks = SDL_GetPerformanceCounter();
+        map->restorePristine();
+        coins.reset();
+        player->reset({startX, startY});
+        camera->unlockY();
+        camera->follow(player->getPosition(), 1.0f);
+        resetSimulationClock();
+        const double elapsedMs =
+            (SDL_GetPerformanceCounter() - startTicks) * 1000.0 / SDL_GetPerformanceFrequency();
+        LOG_INFO(CAT_GAME, "新游戏（复用已加载的关卡）初始化完成，用时 " << elapsedMs << " ms");
+        return;
+    }
+
+    delete map;
+    map = nullptr;
+    delete player;
+    player = nullptr;
+    delete camera;
+    camera = nullptr;
+
     try {
-        map = new TiledMap("assets/maps/level1.tmj", renderer);
+        ImageLoader::Progress progress;
+        if (window) {
+            renderLoadingScreen("地图加载中", 0, 1);
+            progress = [this](int done, int total) { renderLoadingScreen("地图加载中", done, total); };
+        }
+        map = new TiledMap(levelPath, renderer, true, progress);
     } catch (const std::exception& e) {
-        std::cerr << "地图加载失败: " << e.what() << std::endl;
+        LOG_ERROR(CAT_GAME, "地图加载失败: " << e.what());
         return;
     }
 
-    map->setRenderScale(1.0f);
+    map->setRenderScale(RENDER_SCALE);
 
-    
-    std::cout << "==================================== 地图信息 ===========================================" << std::endl;
-    std::cout << "=====================================================================================" << std::endl;
-    std::cout << "=====================================================================================" << std::endl;
-    std::cout << "=====================================================================================" << std::endl;
-    std::cout << "原始尺寸: " << map->getMapPixelWidth() << "x" << map->getMapPixelHeight() << std::endl;
-    std::cout << "内容尺寸: " << map->getContentPixelWidth() << "x" << map->getContentPixelHeight() << std::endl;
-    std::cout << "瓦片尺寸: " << map->getTileWidth() << "x" << map->getTileHeight() << std::endl;
-    std::cout << "屏幕尺寸: " << SCREEN_WIDTH << "x" << SCREEN_HEIGHT << std::endl;
-    std::cout << "=====================================================================================" << std::endl;
-    std::cout << "=====================================================================================" << std::endl;
-    std::cout << "=====================================================================================" << std::endl;
+    LOG_INFO(CAT_MAP, "地图信息 原始尺寸 " << map->getMapPixelWidth() << "x" << map->getMapPixelHeight()
+                      << ", 内容尺寸 " << map->getContentPixelWidth() << "x" << map->getContentPixelHeight()
+                      << ", 瓦片 " << map->getTileWidth() << "x" << map->getTileHeight()
+                      << ", 屏幕 " << SCREEN_WIDTH << "x" << SCREEN_HEIGHT);
 
     camera = new Camera(
         SCREEN_WIDTH, SCREEN_HEIGHT, map->getContentPixelWidth(), map->getContentPixelHeight());
 
-    player = new Player(renderer);
+    player = new Player(renderer, playerSprite);
+    playerSprite = TextureRegion();
+    player->setAudioCallback([this](const std::string& soundName) {
+        audioManager.playSound(soundName);
+        LOG_DEBUG(CAT_AUDIO, "播放音效: " << soundName);
+    });
 
-    float startX = 100.0f;
-    float startY = 100.0f;
     player->setPosition({startX, startY});
 
-    if (!coins.load(renderer, "assets/coin.png")) {
+    coins.clear();
+    if (renderer && !coins.load(renderer, "assets/coin.png")) {
         SDL_Log("加载失败assets/coin.png");
     }
 
     std::vector<SDL_FPoint> coinSpawns = map->getCoinPositions();
-    std::cout << "[Coins] spawn count: " << coinSpawns.size() << std::endl;
+    LOG_INFO(CAT_GAME, "[Coins] spawn count: " << coinSpawns.size());
     coins.spawnFixed(coinSpawns, map->getTileWidth());
 
-    std::cout << "玩家初始位置: (" << startX << ", " << startY << ")" << std::endl;
+    LOG_INFO(CAT_GAME, "玩家初始位置: (" << startX << ", " << startY << ")");
 
     camera->follow(player->getPosition(), 1.0f);
+    resetSimulationClock();
+
+    LOG_INFO(CAT_GAME, "新游戏初始化完成");
+    LOG_INFO(CAT_GAME, "相机初始位置: (" << camera->x << ", " << camera->y << ")");
+}
 
-    std::cout << "新游戏初始化完成" << std::endl;
-    std::cout << "相机初始位置: (" << camera->x << ", " << camera->y << ")" << std::endl;
+float Game::getOutputScale() const {
+    int w = 0, h = 0;
+    if (!renderer || SDL_GetRendererOutputSize(renderer, &w, &h) != 0 || w <= 0 || h <= 0) {
+        return 1.0f;
+    }
+    return std::max((float)w / SCREEN_WIDTH, (float)h / SCREEN_HEIGHT);
 }
 
-bool Game::loadDeathImage() {
-    deathImage = IMG_LoadTexture(renderer, "assets/animations/you_die.png");
+bool Game::loadDeathImage(ImageLoader& images, int index) {
+    deathImage = images.takeTexture(index);
     if (!deathImage) {
-        std::cerr << "无法加载死亡图片: " << IMG_GetError() << std::endl;
-        std::cerr << "文件你确定再这里吗 assets/animations/you_die.png" << std::endl;
+        LOG_ERROR(CAT_GAME, "无法加载死亡图片: " << images.getError(index));
+        LOG_ERROR(CAT_GAME, "文件你确定再这里吗 assets/animations/you_die.png");
         return false;
     }
-    std::cout << "死亡图片加载成功" << std::endl;
+    LOG_INFO(CAT_GAME, "死亡图片加载成功");
     return true;
 }
 
-bool Game::loadWinImage() {
-    winImage = IMG_LoadTexture(renderer, "assets/animations/you_win.png");
+bool Game::loadWinImage(ImageLoader& images, int index) {
+    winImage = images.takeTexture(index);
     if (!winImage) {
-        std::cerr << "无法加载通关图片: " << IMG_GetError() << std::endl;
-        std::cerr << "把文件放在assets/animations/you_win.png" << std::endl;
+        LOG_ERROR(CAT_GAME, "无法加载通关图片: " << images.getError(index));
+        LOG_ERROR(CAT_GAME, "把文件放在assets/animations/you_win.png");
         return false;
     }
-    std::cout << "通关图片加载成功" << std::endl;
+    LOG_INFO(CAT_GAME, "通关图片加载成功");
     return true;
 }
 
-void Game::cleanupDeathImage() {
-    if (deathImage) {
-        SDL_DestroyTexture(deathImage);
-        deathImage = nullptr;
+void Game::renderLoadingScreen(const char* stage, int done, int total) {
+    const Uint32 now = SDL_GetTicks();
+    if (done > 0 && done < total && now - lastLoadingFrame < LOADING_FRAME_MS) {
+        return;
+    }
+    lastLoadingFrame = now;
+    SDL_PumpEvents();  // 加载期间窗口保持响应
+
+    SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);
+    SDL_RenderClear(renderer);
+
+    const int barWidth = SCREEN_WIDTH / 2;
+    const int barHeight = 12;
+    const SDL_Rect frame = {(SCREEN_WIDTH - barWidth) / 2, SCREEN_HEIGHT / 2, barWidth, barHeight};
+    const SDL_Rect fill = {frame.x, frame.y, total > 0 ? barWidth * done / total : 0, barHeight};
+    SDL_SetRenderDrawColor(renderer, 0, 200, 255, 255);
+    SDL_RenderFillRect(renderer, &fill);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderDrawRect(renderer, &frame);
+
+    if (hudFont) {
+        const std::string text = std::string(stage) + " " + std::to_string(done) + "/" + std::to_string(total);
+        SDL_Surface* surface = TTF_RenderUTF8_Blended(hudFont, text.c_str(), SDL_Color{255, 255, 255, 255});
+        if (surface) {
+            SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+            const SDL_Rect dst = {(SCREEN_WIDTH - surface->w) / 2, frame.y - surface->h - 8, surface->w, surface->h};
+            SDL_RenderCopy(renderer, texture, nullptr, &dst);
+            SDL_DestroyTexture(texture);
+            SDL_FreeSurface(surface);
+        }
     }
+
+    SDL_RenderPresent(renderer);
+    SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);
+}
+
+void Game::cleanupDeathImage() {
+    TextureCache::release(deathImage);
+    deathImage = nullptr;
 }
 
 void Game::cleanupWinImage() {
-    if (winImage) {
-        SDL_DestroyTexture(winImage);
-        winImage = nullptr;
-    }
+    TextureCache::release(winImage);
+    winImage = nullptr;
 }
 
 void Game::render() {
+    PROFILE_SCOPE("Game::render");
+    RenderStats::beginFrame();
     SDL_RenderClear(renderer);
 
     if (gameState == STATE_PLAYING) {
-        map->renderBackground(renderer, *camera);
-        map->renderTiles(renderer, *camera);
-        coins.render(renderer, *camera, map->getRenderScale());
-        player->render(renderer, *camera, map->getRenderScale());
+        // 相机同样在上一个与当前模拟状态之间插值
+        Camera view = *camera;
+        view.x = prevCameraX + (camera->x - prevCameraX) * renderAlpha;
+        view.y = prevCameraY + (camera->y - prevCameraY) * renderAlpha;
+
+        map->renderBackground(renderer, view);
+        map->renderTiles(renderer, view);
+        coins.render(renderer, view, map->getRenderScale());
+        player->render(renderer, view, map->getRenderScale(), renderAlpha);
         renderHud();
+        renderPerfOverlay(view);
     }
 
     SDL_RenderPresent(renderer);
 }
 
+void Game::renderPerfOverlay(const Camera& view) {
+    if (!perfOverlay.isVisible()) {
+        return;
+    }
+    // 先取计数，面板自己的绘制不计入
+    PerfOverlay::SceneInfo scene;
+    scene.draws = RenderStats::getCurrent();
+    TiledMap::VisibleTileCounts tiles = map->countVisibleTiles(view);
+    scene.visibleBackTiles = tiles.back;
+    scene.visibleMainTiles = tiles.main;
+    scene.residentChunks = map->getResidentChunks();
+    const TextureCache::Stats textures = TextureCache::getStats();
+    scene.textureCount = textures.textures;
+    scene.textureBytes = textures.residentBytes;
+    scene.tileRenderMode = TiledMap::getTileRenderModeName(map->getTileRenderMode());
+    scene.simSteps = lastSimSteps;
+    perfOverlay.render(renderer, scene);
+}
+
+PlayerInput Game::nextPlayerInput() {
+    PlayerInput input;
+    if (isReplaying()) {
+        // applyReplayEvents 已保证下一条是 TICK 记录
+        const ReplayPlayer::Record* record = replayer.peek();
+        if (record && record->type == REPLAY_TICK) {
+            input = ReplayPlayer::toInput(record->value);
+            replayer.consume();
+        }
+    } else if (!options.headless) {
+        input = PlayerInput::fromKeyboard();
+    } else {
+        input.right = true;
+        if (autopilotHoldTicks > 0) {
+            --autopilotHoldTicks;
+            input.jump = true;
+        } else {
+            autopilotSeed = autopilotSeed * 1664525u + 1013904223u;
+            if ((autopilotSeed >> 24) < 8) {
+                autopilotHoldTicks = 8 + (int)((autopilotSeed >> 16) & 31);
+            }
+        }
+    }
+    recorder.recordTick(input);
+    return input;
+}
+
+bool Game::initReplay() {
+    int tickRate = (int)std::lround(1.0f / SIM_DT);
+    if (isReplaying()) {
+        if (!options.recordPath.empty()) {
+            LOG_ERROR(CAT_REPLAY, "不能同时录制和回放");
+            return false;
+        }
+        if (!replayer.load(options.replayPath, tickRate)) {
+            return false;
+        }
+        if (replayer.getMapPath() != levelPath) {
+            LOG_ERROR(CAT_REPLAY, "回放录制于地图 " << replayer.getMapPath() << "，当前为 " << levelPath);
+            return false;
+        }
+    } else if (!options.recordPath.empty()) {
+        if (!recorder.open(options.recordPath, tickRate, levelPath)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 结束录制；回放时把最终状态与录制时的结束记录对比，用于确认回放是确定性的
+void Game::finishSession() {
+    ReplayEndState end;
+    end.ticks = simTickCount;
+    end.score = (uint64_t)std::max(score, 0);
+    if (player) {
+        end.playerX = player->getPosition().x;
+        end.playerY = player->getPosition().y;
+    }
+    recorder.finish(end);
+
+    if (isReplaying() && replayer.hasEndState()) {
+        const ReplayEndState& expected = replayer.getEndState();
+        bool match = expected.ticks == end.ticks && expected.score == end.score &&
+                     expected.playerX == end.playerX && expected.playerY == end.playerY;
+        if (match) {
+            LOG_INFO(CAT_REPLAY, "回放结果与录制一致: " << end.ticks << " 步, 得分 " << end.score << ", 玩家 ("
+                                 << end.playerX << ", " << end.playerY << ")");
+        } else {
+            LOG_ERROR(CAT_REPLAY, "回放结果与录制不一致: " << end.ticks << " 步, 得分 " << end.score << ", 玩家 ("
+                                  << end.playerX << ", " << end.playerY << ")，录制时为 " << expected.ticks
+                                  << " 步, 得分 " << expected.score << ", 玩家 (" << expected.playerX << ", "
+                                  << expected.playerY << ")");
+        }
+    }
+}
+
+void Game::runHeadless() {
+    if (SDL_Init(SDL_INIT_TIMER) < 0) {
+        LOG_ERROR(CAT_GAME, "SDL 初始化失败: " << SDL_GetError());
+        return;
+    }
+    if (!initReplay()) {
+        return;
+    }
+    if (options.headlessRender && !initHeadlessRenderer()) {
+        return;
+    }
+    isRunning = true;
+
+    if (isReplaying()) {
+        runHeadlessReplay();
+        finishSession();
+        if (!options.tracePath.empty()) {
+            Profiler::writeChromeTrace(options.tracePath);
+        }
+        return;
+    }
+
+    LOG_INFO(CAT_GAME, "无界面模式: " << options.headlessRuns << " 局, 每局最多 "
+                       << options.headlessMaxTicks << " 步");
+
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 simCounter = 0;
+    long long totalTicks = 0;
+    int deaths = 0;
+    int wins = 0;
+    int timeouts = 0;
+
+    for (int run = 0; run < options.headlessRuns && isRunning; ++run) {
+        startNewGame();
+        if (!map || !player || !camera) {
+            LOG_ERROR(CAT_GAME, "无界面模式地图加载失败，停止");
+            break;
+        }
+        recorder.recordMenuChoice(0);
+        gameState = STATE_PLAYING;
+        autopilotSeed = 0x9E3779B9u * (uint32_t)(run + 1);
+        autopilotHoldTicks = 0;
+
+        // 只计模拟本身的耗时，不包括地图加载
+        int ticks = 0;
+        Uint64 start = SDL_GetPerformanceCounter();
+        while (gameState == STATE_PLAYING && ticks < options.headlessMaxTicks) {
+            ticks += stepHeadlessFrame(options.headlessMaxTicks - ticks);
+        }
+        simCounter += SDL_GetPerformanceCounter() - start;
+        totalTicks += ticks;
+
+        const char* outcome = "超时";
+        if (gameState == STATE_DEATH_ANIMATION) {
+            outcome = "死亡";
+            ++deaths;
+        } else if (gameState == STATE_WIN_ANIMATION) {
+            outcome = "通关";
+            ++wins;
+        } else {
+            ++timeouts;
+            recorder.recordEsc();  // 回放时先回到菜单再开下一局
+        }
+        LOG_INFO(CAT_GAME, "[Headless] 第 " << run + 1 << " 局: " << outcome << ", " << ticks << " 步, 得分 "
+                           << score << ", 终点 (" << player->getPosition().x << ", " << player->getPosition().y << ")");
+    }
+
+    double seconds = (double)simCounter / frequency;
+    if (seconds > 0.0) {
+        LOG_INFO(CAT_PERF, "[Headless] 共 " << totalTicks << " 步, 模拟耗时 " << seconds * 1000.0 << "ms, "
+                           << (long long)(totalTicks / seconds) << " 步/秒 (" << totalTicks * SIM_DT / seconds
+                           << " 倍实时)");
+    } else {
+        LOG_INFO(CAT_PERF, "[Headless] 共 " << totalTicks << " 步");
+    }
+    LOG_INFO(CAT_PERF, "[Headless] 死亡 " << deaths << ", 通关 " << wins << ", 超时 " << timeouts);
+    isRunning = false;
+    finishSession();
+    if (!options.tracePath.empty()) {
+        Profiler::writeChromeTrace(options.tracePath);
+    }
+}
+
+// 无界面回放：菜单选择和每步输入都来自回放文件，动画状态直接跳过
+void Game::runHeadlessReplay() {
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 start = SDL_GetPerformanceCounter();
+    while (isRunning) {
+        switch (gameState) {
+            case STATE_MENU:
+                runMenuState();
+                break;
+            case STATE_PLAYING:
+            case STATE_PAUSED:
+                stepHeadlessFrame(HEADLESS_FRAME_TICKS);
+                break;
+            case STATE_DEATH_ANIMATION:
+            case STATE_WIN_ANIMATION:
+                if (player) {
+                    player->respawn();
+                }
+                gameState = STATE_MENU;
+                break;
+        }
+    }
+    double seconds = (double)(SDL_GetPerformanceCounter() - start) / frequency;
+    if (seconds > 0.0) {
+        LOG_INFO(CAT_PERF, "[Headless] 回放 " << simTickCount << " 步, 耗时 " << seconds * 1000.0 << "ms, "
+                           << (long long)(simTickCount / seconds) << " 步/秒");
+    } else {
+        LOG_INFO(CAT_PERF, "[Headless] 回放 " << simTickCount << " 步");
+    }
+}
+
+bool Game::initHeadlessRenderer() {
+    if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+        LOG_ERROR(CAT_GAME, "SDL_image 初始化失败: " << IMG_GetError());
+        return false;
+    }
+    softwareTarget = SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_RGBA8888);
+    if (softwareTarget) {
+        renderer = SDL_CreateSoftwareRenderer(softwareTarget);
+    }
+    if (!renderer) {
+        LOG_ERROR(CAT_GAME, "软件渲染器创建失败: " << SDL_GetError());
+        return false;
+    }
+    SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);
+    initHudFont();
+    LOG_INFO(CAT_GAME, "无界面模式使用软件渲染器 " << SCREEN_WIDTH << "x" << SCREEN_HEIGHT);
+    return true;
+}
+
+// 无界面模式推进一帧，返回实际执行的模拟步数。
+// 没有渲染器时一帧就是一步；有软件渲染器时推进 HEADLESS_FRAME_TICKS 步再画一帧，并记录两部分耗时
+int Game::stepHeadlessFrame(int maxSteps) {
+    const int frameTicks = std::min(maxSteps, renderer ? HEADLESS_FRAME_TICKS : 1);
+    const double counterToMs = 1000.0 / (double)SDL_GetPerformanceFrequency();
+    Uint64 updateStart = SDL_GetPerformanceCounter();
+
+    int steps = 0;
+    while (steps < frameTicks && gameState == STATE_PLAYING) {
+        if (isReplaying() && !applyReplayEvents()) {
+            break;
+        }
+        update(SIM_DT);
+        ++steps;
+    }
+    if (!renderer || gameState != STATE_PLAYING || !isRunning) {
+        return steps;
+    }
+
+    Uint64 renderStart = SDL_GetPerformanceCounter();
+    FrameTiming timing;
+    timing.updateMs = (float)((renderStart - updateStart) * counterToMs);
+    renderAlpha = 1.0f;
+    render();
+    timing.renderMs = (float)((SDL_GetPerformanceCounter() - renderStart) * counterToMs);
+    frameTimings.push_back(timing);
+    return steps;
+}
+
 void Game::run() {
+    Profiler::setThreadName("main");  // 游戏循环、加载和渲染都在调用 run 的线程上
+
+    if (options.headless) {
+        runHeadless();
+        return;
+    }
+
     if (!init()) {
-        std::cerr << "初始化失败，程序终止" << std::endl;
+        LOG_ERROR(CAT_GAME, "初始化失败，程序终止");
+        return;
+    }
+    if (!initReplay()) {
+        LOG_ERROR(CAT_GAME, "回放/录制初始化失败，程序终止");
         return;
     }
 
-    std::cout << "游戏初始化成功，开始主循环" << std::endl;
+    LOG_INFO(CAT_GAME, "游戏初始化成功，开始主循环");
 
     while (isRunning) {
         Uint32 currentTime = SDL_GetTicks();
-        deltaTime = (currentTime - lastUpdateTime) / 1000.0f;
-        lastUpdateTime = currentTime;
+        deltaTime = (float)pacer.getLastFrameSeconds();
 
         if (deltaTime > MAX_DELTA_TIME) {
-            std::cout << "帧时间过长 " << deltaTime * 1000 << "ms, 限制到 "
-                      << MAX_DELTA_TIME * 1000 << "ms" << std::endl;
+            LOG_WARN(CAT_PERF, "帧时间过长 " << deltaTime * 1000 << "ms, 限制到 "
+                               << MAX_DELTA_TIME * 1000 << "ms");
             deltaTime = MAX_DELTA_TIME;
         }
 
@@ -626,27 +1101,42 @@ void Game::run() {
         frameCount++;
         if (currentTime - lastFpsTime >= 1000) {
             float fps = frameCount / ((currentTime - lastFpsTime) / 1000.0f);
-            std::cout << "FPS: " << fps << ", DeltaTime: " << deltaTime * 1000 << "ms" << std::endl;
+            FramePacer::Stats stats = pacer.computeStats();
+            LOG_INFO(CAT_PERF, "FPS: " << fps << ", DeltaTime: " << deltaTime * 1000 << "ms"
+                               << ", 帧间隔 p50/p99: " << stats.p50Ms << "/" << stats.p99Ms << "ms");
             frameCount = 0;
             lastFpsTime = currentTime;
         }
 
-        switch (gameState) {
-            case STATE_MENU:
-                runMenuState();
-                break;
-            case STATE_PLAYING:
-                runPlayingState();
-                break;
-            case STATE_PAUSED:
-                runPlayingState();
-                break;
-            case STATE_DEATH_ANIMATION:
-                runDeathAnimationState();
-                break;
-            case STATE_WIN_ANIMATION:
-                runWinAnimationState();
-                break;
+        {
+            PROFILE_SCOPE("Game::frame");
+            switch (gameState) {
+                case STATE_MENU:
+                    runMenuState();
+                    break;
+                case STATE_PLAYING:
+                    runPlayingState();
+                    break;
+                case STATE_PAUSED:
+                    runPlayingState();
+                    break;
+                case STATE_DEATH_ANIMATION:
+                    runDeathAnimationState();
+                    break;
+                case STATE_WIN_ANIMATION:
+                    runWinAnimationState();
+                    break;
+            }
+        }
+
+        {
+            PROFILE_SCOPE("FramePacer::wait");
+            pacer.endFrame();
         }
     }
+
+    finishSession();
+    if (!options.tracePath.empty()) {
+        Profiler::writeChromeTrace(options.tracePath);
+    }
 }
@@ -10,15 +10,51 @@
 #include "StartMenu.h"
 #include "Coin.hpp"
 #include "AudioManager.h"
+#include "FramePacer.h"
+#include "Replay.h"
+#include "PerfOverlay.h"
+#include <string>
+#include <vector>
+
+// 启动参数（由 main 解析命令行得到）
+struct GameOptions {
+    FramePacer::Mode frameMode = FramePacer::MODE_VSYNC;
+    int targetFps = 60;  // 仅 MODE_CAPPED 使用
+
+    // 无界面模式：不创建窗口/渲染器/音频，按固定步长尽可能快地模拟若干局
+    bool headless = false;
+    int headlessRuns = 1;
+    int headlessMaxTicks = 120 * 120;  // 每局最多模拟的步数（默认 2 分钟游戏时间）
+    // 无界面模式下用 SDL 软件渲染器按 60 FPS 节奏画每一帧（仍不创建窗口），记录每帧更新/渲染耗时
+    bool headlessRender = false;
+
+    // 输入录制/回放（.egrp），两者互斥；回放时忽略键盘和菜单，按文件确定性地重演
+    std::string recordPath;
+    std::string replayPath;
+
+    // 性能追踪（Chrome trace JSON）：非空时退出时导出到该文件，F9 随时导出（默认 trace.json）
+    std::string tracePath;
+
+    // TextureCache 的显存预算（MB），超出时淘汰没有引用的纹理
+    int textureBudgetMB = 256;
+};
 
 class Game {
 public:
     Game();
+    explicit Game(const GameOptions& options);
     ~Game();
     bool init();
     void run();
     glm::vec2 getPlayerPosition() const { return player->getPosition(); }
 
+    // headlessRender 时每帧的耗时，供基准程序做帧时间回归
+    struct FrameTiming {
+        float updateMs = 0.0f;
+        float renderMs = 0.0f;
+    };
+    const std::vector<FrameTiming>& getFrameTimings() const { return frameTimings; }
+
     enum GameState {
         STATE_MENU,
         STATE_PLAYING,
@@ -33,15 +69,27 @@ private:
     bool isRunning = false;
     const int SCREEN_WIDTH = 800;
     const int SCREEN_HEIGHT = 350;
+    const float RENDER_SCALE = 1.0f;
+    const float OVERLAY_IMAGE_SCALE = 0.8f;  // 比屏幕大的死亡/通关图片缩到屏幕的 80% 以内
+    float getOutputScale() const;            // 渲染器实际输出像素 / 逻辑屏幕尺寸，图片 LOD 按它放大
 
     AudioManager audioManager;
     
     bool menuMusicStarted = false;
     bool gameMusicStarted = false;
     
-    Uint32 lastUpdateTime = 0;
+    GameOptions options;
+    FramePacer pacer;
     float deltaTime = 0.016f;
-    const float MAX_DELTA_TIME = 0.05f;
+    const float MAX_DELTA_TIME = 0.1f;
+
+    // 固定步长模拟：Player/CoinManager/Camera 以 SIM_DT 推进，渲染在最近两个模拟状态之间插值
+    const float SIM_DT = 1.0f / 120.0f;
+    const int MAX_SIM_STEPS_PER_FRAME = 12;
+    float simAccumulator = 0.0f;
+    float renderAlpha = 1.0f;
+    float prevCameraX = 0.0f;
+    float prevCameraY = 0.0f;
 
     TiledMap* map = nullptr;
     Player* player = nullptr;
@@ -57,9 +105,23 @@ private:
     Uint32 winStartTime = 0;
     const Uint32 WIN_DISPLAY_TIME = 300000;
 
+    TextureRegion playerSprite;  // init 时和其他图片一起并行解码（打进图集），第一次创建 Player 时交给它
+
+    // 加载画面：图片并行解码期间显示进度条，最多每 LOADING_FRAME_MS 重画一次（垂直同步下 Present 会阻塞）
+    const Uint32 LOADING_FRAME_MS = 33;
+    Uint32 lastLoadingFrame = 0;
+    void renderLoadingScreen(const char* stage, int done, int total);
+
     CoinManager coins;
     int score = 0;
 
+    // 性能面板（F3）：更新/渲染耗时按帧记录，面板画在 HUD 之后
+    PerfOverlay perfOverlay;
+    float lastUpdateMs = 0.0f;
+    float lastRenderMs = 0.0f;
+    int lastSimSteps = 0;
+    void renderPerfOverlay(const Camera& view);
+
     TTF_Font* hudFont = nullptr;
     SDL_Texture* scoreTexture = nullptr;
     int scoreTexW = 0;
@@ -70,8 +132,33 @@ private:
     void renderHud();
     void cleanupHudText();
 
+    // 无界面模式的自动驾驶输入：一直向右，按每局不同的伪随机序列起跳
+    uint32_t autopilotSeed = 1;
+    int autopilotHoldTicks = 0;
+    PlayerInput nextPlayerInput();
+    void runHeadless();
+    void runHeadlessReplay();
+
+    // 软件渲染的无界面模式：渲染目标是内存中的 surface，每帧推进 2 个模拟步（120 Hz 模拟、60 FPS 画面）
+    const int HEADLESS_FRAME_TICKS = 2;
+    SDL_Surface* softwareTarget = nullptr;
+    std::vector<FrameTiming> frameTimings;
+    bool initHeadlessRenderer();
+    int stepHeadlessFrame(int maxSteps);
+
+    const std::string levelPath = "assets/maps/level1.tmj";
+    uint64_t simTickCount = 0;  // 本次运行实际执行的模拟步数
+    ReplayRecorder recorder;
+    ReplayPlayer replayer;
+    bool isReplaying() const { return !options.replayPath.empty(); }
+    bool initReplay();
+    bool applyReplayEvents();
+    void finishSession();
+    void returnToMenu();
+
     void handleEvents();
     void update(float deltaTime);
+    void resetSimulationClock();
     void render();
     void runMenuState();
     void runPlayingState();
@@ -80,8 +167,8 @@ private:
     void startNewGame();
     void handlePlayerDeath();
     void handlePlayerWin();
-    bool loadDeathImage();
-    bool loadWinImage();
+    bool loadDeathImage(ImageLoader& images, int index);
+    bool loadWinImage(ImageLoader& images, int index);
     void cleanupDeathImage();
     void cleanupWinImage();
     
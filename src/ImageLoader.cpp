@@ -0,0 +1,177 @@
+#include "ImageLoader.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "TextureCache.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+ImageLoader::~ImageLoader() {
+    for (Entry& entry : entries) {
+        if (entry.surface) SDL_FreeSurface(entry.surface);
+        TextureCache::release(entry.texture);
+    }
+}
+
+int ImageLoader::add(const std::string& path, const TextureCache::Lod& lod) {
+    Entry entry;
+    entry.path = path;
+    entry.lod = lod;
+    entries.push_back(std::move(entry));
+    return (int)entries.size() - 1;
+}
+
+int ImageLoader::addPacked(const std::string& path, const TextureCache::Lod& lod) {
+    const int index = add(path, lod);
+    entries[index].packed = true;
+    return index;
+}
+
+int ImageLoader::getThreadCount() {
+    return std::max(1, (int)std::thread::hardware_concurrency());
+}
+
+// 工作线程调用；SDL 的错误信息是线程局部的，decodeFile 在这个线程里就把它取出来
+void ImageLoader::decode(Entry& entry) {
+    entry.surface = TextureCache::decodeFile(entry.path, entry.lod, entry.content, entry.error);
+}
+
+// 交给纹理缓存上传：内容和已缓存的纹理相同时直接复用
+void ImageLoader::upload(SDL_Renderer* renderer, Entry& entry) {
+    if (!entry.surface) return;
+    if (entry.packed) {
+        TextureRegion region;
+        if (TextureAtlas::insert(renderer, entry.path, entry.lod, entry.content, entry.surface, region,
+                                 entry.error)) {
+            entry.texture = region.texture;
+            entry.src = region.src;
+        }
+    } else {
+        entry.texture =
+            TextureCache::insert(renderer, entry.path, entry.lod, entry.content, entry.surface, entry.error);
+    }
+    SDL_FreeSurface(entry.surface);
+    entry.surface = nullptr;
+}
+
+void ImageLoader::load(SDL_Renderer* renderer, const Progress& progress) {
+    PROFILE_SCOPE("ImageLoader::load");
+    const int total = (int)entries.size();
+    if (total == 0) return;
+    const Uint64 startTicks = SDL_GetPerformanceCounter();
+
+    // 已经在纹理缓存里的不用再解码
+    int done = 0;
+    std::vector<int> order;
+    std::vector<uintmax_t> fileSizes(total, 0);
+    for (int i = 0; i < total; ++i) {
+        Entry& entry = entries[i];
+        if (entry.packed) {
+            TextureRegion region;
+            if (TextureAtlas::find(renderer, entry.path, entry.lod, region)) {
+                entry.texture = region.texture;
+                entry.src = region.src;
+            }
+        } else {
+            entry.texture = TextureCache::find(renderer, entry.path, entry.lod);
+        }
+        if (entry.texture) {
+            ++done;
+            continue;
+        }
+        order.push_back(i);
+        std::error_code ec;
+        fileSizes[i] = std::filesystem::file_size(std::filesystem::u8path(entry.path), ec);
+    }
+    if (progress && done > 0) progress(done, total);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return fileSizes[a] > fileSizes[b]; });
+
+    const int pending = (int)order.size();
+    const int threadCount = std::min(getThreadCount(), pending);
+    std::mutex mutex;
+    std::condition_variable decodedCv;
+    std::deque<int> decoded;  // 已解码、等待上传的序号
+    std::atomic<int> next{0};
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+    for (int t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&] {
+            for (int i = next++; i < pending; i = next++) {
+                decode(entries[order[i]]);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    decoded.push_back(order[i]);
+                }
+                decodedCv.notify_one();
+            }
+        });
+    }
+
+    // 要打包的图片等全部解码完，再按高度从高到低装箱：布局不受线程调度影响，也更紧凑
+    std::vector<int> packedIndices;
+    for (int received = 0; received < pending; ++received) {
+        int index;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            decodedCv.wait(lock, [&] { return !decoded.empty(); });
+            index = decoded.front();
+            decoded.pop_front();
+        }
+        if (entries[index].packed) {
+            packedIndices.push_back(index);
+            continue;
+        }
+        upload(renderer, entries[index]);
+        ++done;
+        if (progress) progress(done, total);
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    auto heightOf = [&](int index) { return entries[index].surface ? entries[index].surface->h : 0; };
+    std::sort(packedIndices.begin(), packedIndices.end(), [&](int a, int b) {
+        return heightOf(a) != heightOf(b) ? heightOf(a) > heightOf(b) : a < b;
+    });
+    size_t packedPixels = 0;
+    for (int index : packedIndices) {
+        const SDL_Surface* surface = entries[index].surface;
+        if (surface && TextureAtlas::fits(surface->w, surface->h)) {
+            packedPixels += (size_t)(surface->w + TextureAtlas::PADDING) * (surface->h + TextureAtlas::PADDING);
+        }
+    }
+    TextureAtlas::reserve(renderer, packedPixels);
+    for (int index : packedIndices) {
+        upload(renderer, entries[index]);
+        ++done;
+        if (progress) progress(done, total);
+    }
+
+    const double elapsedMs = (SDL_GetPerformanceCounter() - startTicks) * 1000.0 / SDL_GetPerformanceFrequency();
+    LOG_INFO(CAT_PERF, "ImageLoader: " << total << " images (" << total - pending << " cached), " << threadCount
+                       << " decode threads, " << elapsedMs << " ms");
+}
+
+SDL_Texture* ImageLoader::takeTexture(int index) {
+    if (index < 0 || index >= (int)entries.size()) return nullptr;
+    SDL_Texture* texture = entries[index].texture;
+    entries[index].texture = nullptr;
+    return texture;
+}
+
+TextureRegion ImageLoader::takeRegion(int index) {
+    TextureRegion region;
+    region.texture = takeTexture(index);
+    if (region.texture) {
+        region.src = entries[index].src;
+        if (!entries[index].packed) {
+            SDL_QueryTexture(region.texture, nullptr, nullptr, &region.src.w, &region.src.h);
+        }
+    }
+    return region;
+}
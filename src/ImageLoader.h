@@ -0,0 +1,56 @@
+#pragma once
+#include "TextureAtlas.h"
+#include "TextureCache.h"
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 图片批量加载：PNG 在工作线程上并行解码成 SDL_Surface，
+// 纹理上传必须在渲染线程，由调用 load 的线程边解码边交给 TextureCache 上传（addPacked 的小图打进 TextureAtlas）；
+// 已缓存的图片不再解码。
+class ImageLoader {
+public:
+    // 每上传完一张图片回调一次（在调用 load 的线程上），可以用来画加载画面
+    using Progress = std::function<void(int done, int total)>;
+
+    ImageLoader() = default;
+    ~ImageLoader();  // 没有被取走的纹理归还给 TextureCache
+    ImageLoader(const ImageLoader&) = delete;
+    ImageLoader& operator=(const ImageLoader&) = delete;
+
+    // 返回序号，load 之后用它取纹理；lod 是图片最大的绘制尺寸，解码后在工作线程上缩小
+    int add(const std::string& path, const TextureCache::Lod& lod = TextureCache::Lod());
+    // 同 add，但图片打包进图集（放不下一页时仍是单独纹理），用 takeRegion 取
+    int addPacked(const std::string& path, const TextureCache::Lod& lod = TextureCache::Lod());
+    int getCount() const { return (int)entries.size(); }
+
+    // 解码并上传所有已添加的图片；文件大的先解码，避免最后只剩一个线程在解一张大图
+    void load(SDL_Renderer* renderer, const Progress& progress = nullptr);
+
+    // 纹理的一个引用交给调用方（用完 TextureCache::release），加载失败为 nullptr
+    SDL_Texture* takeTexture(int index);
+    TextureRegion takeRegion(int index);  // 同 takeTexture，另外给出图片在纹理里的源矩形
+    const std::string& getPath(int index) const { return entries[index].path; }
+    const std::string& getError(int index) const { return entries[index].error; }
+
+    static int getThreadCount();  // 解码线程数：硬件线程数，至少 1
+
+private:
+    struct Entry {
+        std::string path;
+        TextureCache::Lod lod;
+        SDL_Surface* surface = nullptr;
+        TextureContent content;
+        SDL_Texture* texture = nullptr;
+        SDL_Rect src = {0, 0, 0, 0};  // 打包的图片在图集页里的位置
+        bool packed = false;
+        std::string error;
+    };
+
+    void decode(Entry& entry);
+    void upload(SDL_Renderer* renderer, Entry& entry);
+
+    std::vector<Entry> entries;
+};
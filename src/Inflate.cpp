@@ -0,0 +1,410 @@
+#include "Inflate.h"
+#include <cstring>
+#include <memory>
+
+namespace {
+
+const int MAX_BITS = 15;
+const int FAST_BITS = 10;  // 不超过 10 位的码一次查表解出，更长的码逐位解码（很少出现）
+const uint32_t WINDOW_SIZE = 32768;
+const uint32_t RING_MASK = WINDOW_SIZE * 2 - 1;  // 环形缓冲区放两个窗口：一半在回溯，另一半在填充
+
+const uint16_t LENGTH_BASE[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                  31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const uint16_t DIST_BASE[30] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                                193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+const uint8_t DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+const uint8_t CODE_LENGTH_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// 范式 Huffman 表：count/symbol 用于逐位解码，fast 以接下来 FAST_BITS 位（按位倒序）为下标
+struct Huffman {
+    uint16_t fast[1 << FAST_BITS];  // (码长 << 9) | 符号，0 表示码长超过 FAST_BITS
+    uint16_t count[MAX_BITS + 1];
+    uint16_t symbol[288];
+
+    bool build(const uint8_t* lengths, int n) {
+        std::memset(count, 0, sizeof(count));
+        for (int i = 0; i < n; ++i) {
+            count[lengths[i]]++;
+        }
+        count[0] = 0;
+        int left = 1;
+        for (int len = 1; len <= MAX_BITS; ++len) {
+            left = (left << 1) - count[len];
+            if (left < 0) return false;  // 码长超额，不是合法的前缀码
+        }
+
+        uint16_t offsets[MAX_BITS + 2] = {0};
+        for (int len = 1; len <= MAX_BITS; ++len) {
+            offsets[len + 1] = offsets[len] + count[len];
+        }
+        for (int i = 0; i < n; ++i) {
+            if (lengths[i]) symbol[offsets[lengths[i]]++] = (uint16_t)i;
+        }
+
+        std::memset(fast, 0, sizeof(fast));
+        int code = 0;
+        int index = 0;
+        for (int len = 1; len <= FAST_BITS; ++len) {
+            for (int k = 0; k < count[len]; ++k) {
+                int reversed = 0;
+                for (int bit = 0, c = code + k; bit < len; ++bit, c >>= 1) {
+                    reversed = (reversed << 1) | (c & 1);
+                }
+                const uint16_t entry = (uint16_t)((len << 9) | symbol[index + k]);
+                for (int fill = reversed; fill < (1 << FAST_BITS); fill += 1 << len) {
+                    fast[fill] = entry;
+                }
+            }
+            index += count[len];
+            code = (code + count[len]) << 1;
+        }
+        return true;
+    }
+};
+
+uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t size) {
+    static const struct Table {
+        uint32_t entries[256];
+        Table() {
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                entries[i] = c;
+            }
+        }
+    } table;
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+uint32_t adler32Update(uint32_t adler, const uint8_t* data, size_t size) {
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+    while (size > 0) {
+        size_t block = size < 5552 ? size : 5552;  // 5552 字节内累加不会溢出 32 位
+        size -= block;
+        while (block-- > 0) {
+            a += *data++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+class Inflater {
+public:
+    Inflater(const uint8_t* data, size_t size, const Inflate::Sink& sink, Inflate::Format format)
+        : in(data), inSize(size), sink(sink), format(format) {}
+
+    bool run(size_t start, std::string& error);
+    uint32_t getChecksum() const { return checksum; }
+    uint64_t getOutputSize() const { return outPos; }
+    size_t getEndOffset() const { return inPos - bitCount / 8; }  // 最后一个块之后（已按字节对齐）的输入位置
+
+private:
+    void refill() {
+        while (bitCount <= 56) {
+            const uint64_t byte = inPos < inSize ? in[inPos] : 0;  // 读过末尾补 0，由 truncated() 发现
+            ++inPos;
+            bitBuffer |= byte << bitCount;
+            bitCount += 8;
+        }
+    }
+    uint32_t bits(int n) {
+        if (bitCount < n) refill();
+        const uint32_t value = (uint32_t)(bitBuffer & ((1ull << n) - 1));
+        bitBuffer >>= n;
+        bitCount -= n;
+        return value;
+    }
+    bool truncated() const { return inPos * 8 - bitCount > (uint64_t)inSize * 8; }
+
+    int decode(const Huffman& table) {
+        if (bitCount < MAX_BITS) refill();
+        const uint16_t entry = table.fast[bitBuffer & ((1u << FAST_BITS) - 1)];
+        if (entry) {
+            const int len = entry >> 9;
+            bitBuffer >>= len;
+            bitCount -= len;
+            return entry & 0x1FF;
+        }
+        int code = 0, first = 0, index = 0;
+        for (int len = 1; len <= MAX_BITS; ++len) {
+            code |= (int)bits(1);
+            const int count = table.count[len];
+            if (code - count < first) return table.symbol[index + (code - first)];
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        return -1;  // 不完整的码表里没有这个码
+    }
+
+    void put(uint8_t byte) {
+        window[outPos & RING_MASK] = byte;
+        if ((++outPos & (WINDOW_SIZE - 1)) == 0) flush();
+    }
+    // flushed 总是 WINDOW_SIZE 的整数倍，所以待交出的部分在环形缓冲区里是连续的
+    void flush() {
+        const size_t size = (size_t)(outPos - flushed);
+        if (size == 0 || aborted) return;
+        const uint8_t* data = window + (flushed & RING_MASK);
+        checksum = format == Inflate::FORMAT_GZIP ? crc32Update(checksum, data, size)
+                                                  : adler32Update(checksum, data, size);
+        if (!sink(data, size)) aborted = true;
+        flushed = outPos;
+    }
+
+    bool storedBlock(std::string& error);
+    bool huffmanBlock(const Huffman& literals, const Huffman& distances, std::string& error);
+    bool dynamicTables(Huffman& literals, Huffman& distances, std::string& error);
+
+    const uint8_t* in;
+    size_t inSize;
+    size_t inPos = 0;
+    uint64_t bitBuffer = 0;
+    int bitCount = 0;
+    const Inflate::Sink& sink;
+    Inflate::Format format;
+    uint32_t checksum = 0;
+    bool aborted = false;
+    uint64_t outPos = 0;
+    uint64_t flushed = 0;
+    uint8_t window[WINDOW_SIZE * 2];
+};
+
+bool Inflater::run(size_t start, std::string& error) {
+    inPos = start;
+    checksum = format == Inflate::FORMAT_GZIP ? 0 : 1;
+    Huffman literals, distances;
+    bool last = false;
+    while (!last) {
+        last = bits(1) != 0;
+        const uint32_t type = bits(2);
+        bool ok = false;
+        if (type == 0) {
+            ok = storedBlock(error);
+        } else if (type == 1) {
+            uint8_t lengths[288 + 30];
+            std::memset(lengths, 8, 144);
+            std::memset(lengths + 144, 9, 112);
+            std::memset(lengths + 256, 7, 24);
+            std::memset(lengths + 280, 8, 8);
+            std::memset(lengths + 288, 5, 30);
+            literals.build(lengths, 288);
+            distances.build(lengths + 288, 30);
+            ok = huffmanBlock(literals, distances, error);
+        } else if (type == 2) {
+            ok = dynamicTables(literals, distances, error) && huffmanBlock(literals, distances, error);
+        } else {
+            error = "invalid block type";
+        }
+        if (!ok) return false;
+        if (truncated()) {
+            error = "unexpected end of data";
+            return false;
+        }
+    }
+    flush();
+    if (aborted) {
+        error = "aborted";
+        return false;
+    }
+    bitBuffer >>= bitCount % 8;  // 尾部校验和从字节边界开始
+    bitCount -= bitCount % 8;
+    return true;
+}
+
+bool Inflater::storedBlock(std::string& error) {
+    bitBuffer >>= bitCount % 8;
+    bitCount -= bitCount % 8;
+    const uint32_t length = bits(16);
+    const uint32_t complement = bits(16);
+    if ((length ^ 0xFFFF) != complement) {
+        error = "stored block length mismatch";
+        return false;
+    }
+    for (uint32_t i = 0; i < length && !aborted; ++i) {
+        put((uint8_t)bits(8));
+    }
+    return true;
+}
+
+bool Inflater::dynamicTables(Huffman& literals, Huffman& distances, std::string& error) {
+    const int literalCount = (int)bits(5) + 257;
+    const int distanceCount = (int)bits(5) + 1;
+    const int codeLengthCount = (int)bits(4) + 4;
+    if (literalCount > 286 || distanceCount > 30) {
+        error = "too many length or distance codes";
+        return false;
+    }
+
+    uint8_t lengths[288 + 32] = {0};
+    for (int i = 0; i < codeLengthCount; ++i) {
+        lengths[CODE_LENGTH_ORDER[i]] = (uint8_t)bits(3);
+    }
+    Huffman codeLengths;
+    if (!codeLengths.build(lengths, 19)) {
+        error = "invalid code length table";
+        return false;
+    }
+
+    std::memset(lengths, 0, sizeof(lengths));
+    const int total = literalCount + distanceCount;
+    for (int i = 0; i < total;) {
+        const int symbol = decode(codeLengths);
+        if (symbol < 0) {
+            error = "invalid code length code";
+            return false;
+        }
+        if (symbol < 16) {
+            lengths[i++] = (uint8_t)symbol;
+            continue;
+        }
+        uint8_t value = 0;
+        int repeat;
+        if (symbol == 16) {
+            if (i == 0) {
+                error = "repeat with no previous length";
+                return false;
+            }
+            value = lengths[i - 1];
+            repeat = 3 + (int)bits(2);
+        } else if (symbol == 17) {
+            repeat = 3 + (int)bits(3);
+        } else {
+            repeat = 11 + (int)bits(7);
+        }
+        if (i + repeat > total) {
+            error = "too many code lengths";
+            return false;
+        }
+        while (repeat-- > 0) lengths[i++] = value;
+    }
+    if (lengths[256] == 0) {
+        error = "missing end-of-block code";
+        return false;
+    }
+    if (!literals.build(lengths, literalCount) || !distances.build(lengths + literalCount, distanceCount)) {
+        error = "invalid literal/length or distance table";
+        return false;
+    }
+    return true;
+}
+
+bool Inflater::huffmanBlock(const Huffman& literals, const Huffman& distances, std::string& error) {
+    for (;;) {
+        int symbol = decode(literals);
+        if (symbol < 256) {
+            if (symbol < 0) {
+                error = "invalid literal/length code";
+                return false;
+            }
+            put((uint8_t)symbol);
+        } else if (symbol == 256) {
+            return true;
+        } else {
+            symbol -= 257;
+            if (symbol >= 29) {
+                error = "invalid length code";
+                return false;
+            }
+            const uint32_t length = LENGTH_BASE[symbol] + bits(LENGTH_EXTRA[symbol]);
+            const int distanceSymbol = decode(distances);
+            if (distanceSymbol < 0 || distanceSymbol >= 30) {
+                error = "invalid distance code";
+                return false;
+            }
+            const uint32_t distance = DIST_BASE[distanceSymbol] + bits(DIST_EXTRA[distanceSymbol]);
+            if (distance > outPos) {
+                error = "distance too far back";
+                return false;
+            }
+            for (uint32_t i = 0; i < length; ++i) {
+                put(window[(outPos - distance) & RING_MASK]);
+            }
+        }
+        if (aborted || truncated()) {
+            error = aborted ? "aborted" : "unexpected end of data";
+            return false;
+        }
+    }
+}
+
+uint32_t readBigEndian32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+uint32_t readLittleEndian32(const uint8_t* p) {
+    return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// gzip 头长度（跳过可选的 extra/文件名/注释/头校验），格式不对返回 0
+size_t gzipHeaderSize(const uint8_t* data, size_t size) {
+    if (size < 10 || data[0] != 0x1F || data[1] != 0x8B || data[2] != 8) return 0;
+    const uint8_t flags = data[3];
+    size_t pos = 10;
+    if (flags & 0x04) {  // FEXTRA
+        if (pos + 2 > size) return 0;
+        pos += 2 + (data[pos] | (data[pos + 1] << 8));
+    }
+    for (uint8_t bit : {0x08, 0x10}) {  // FNAME、FCOMMENT：以 0 结尾的字符串
+        if (flags & bit) {
+            while (pos < size && data[pos] != 0) ++pos;
+            ++pos;
+        }
+    }
+    if (flags & 0x02) pos += 2;  // FHCRC
+    return pos < size ? pos : 0;
+}
+
+}  // namespace
+
+bool Inflate::decompress(const uint8_t* data, size_t size, Format format, const Sink& sink, std::string& error) {
+    size_t start = 0;
+    if (format == FORMAT_ZLIB) {
+        if (size < 6 || (data[0] & 0x0F) != 8 || (data[0] >> 4) > 7 || ((data[0] << 8) | data[1]) % 31 != 0) {
+            error = "invalid zlib header";
+            return false;
+        }
+        if (data[1] & 0x20) {
+            error = "zlib preset dictionary not supported";
+            return false;
+        }
+        start = 2;
+    } else if (format == FORMAT_GZIP) {
+        start = gzipHeaderSize(data, size);
+        if (start == 0) {
+            error = "invalid gzip header";
+            return false;
+        }
+    }
+
+    // 环形窗口 64 KB，放在堆上，工作线程里调用也不会压栈
+    std::unique_ptr<Inflater> inflater(new Inflater(data, size, sink, format));
+    if (!inflater->run(start, error)) {
+        return false;
+    }
+
+    const size_t end = inflater->getEndOffset();
+    if (format == FORMAT_ZLIB) {
+        if (end + 4 > size || readBigEndian32(data + end) != inflater->getChecksum()) {
+            error = "zlib checksum mismatch";
+            return false;
+        }
+    } else if (format == FORMAT_GZIP) {
+        if (end + 8 > size || readLittleEndian32(data + end) != inflater->getChecksum() ||
+            readLittleEndian32(data + end + 4) != (uint32_t)inflater->getOutputSize()) {
+            error = "gzip checksum mismatch";
+            return false;
+        }
+    }
+    return true;
+}
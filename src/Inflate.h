@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// DEFLATE 解压（RFC 1950/1951/1952），用于 Tiled 的 zlib/gzip 压缩图层。
+// 流式输出：只保留 32 KB 回溯窗口，解压结果分段交给 sink，调用方可以直接写进最终的数据结构。
+class Inflate {
+public:
+    enum Format {
+        FORMAT_RAW,   // 裸 deflate 流
+        FORMAT_ZLIB,  // 2 字节头 + deflate + Adler-32
+        FORMAT_GZIP   // gzip 头 + deflate + CRC-32 + 长度
+    };
+
+    // 每段最多 32 KB；sink 返回 false 时中止解压（decompress 返回 false，error 为 "aborted"）
+    using Sink = std::function<bool(const uint8_t* data, size_t size)>;
+
+    // 数据损坏、被截断或校验和不符时返回 false，error 说明原因
+    static bool decompress(const uint8_t* data, size_t size, Format format, const Sink& sink, std::string& error);
+};
@@ -0,0 +1,240 @@
+#include "Log.h"
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct LogEntry {
+    Log::Level level = Log::LEVEL_INFO;
+    Log::Category category = Log::CAT_GAME;
+    Uint32 timeMs = 0;
+    std::string text;
+};
+
+// 有界多生产者队列（Vyukov 算法）：每个槽位带序号，生产者用 CAS 抢下标，不加锁
+class LogQueue {
+public:
+    static const size_t CAPACITY = 4096;  // 必须是 2 的幂
+
+    LogQueue() : slots(CAPACITY) {
+        for (size_t i = 0; i < CAPACITY; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(LogEntry&& entry) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[pos & (CAPACITY - 1)];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.entry = std::move(entry);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // 满了
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 只有后台线程调用
+    bool pop(LogEntry& entry) {
+        Slot& slot = slots[dequeuePos & (CAPACITY - 1)];
+        size_t seq = slot.sequence.load(std::memory_order_acquire);
+        if ((intptr_t)seq - (intptr_t)(dequeuePos + 1) < 0) {
+            return false;  // 空
+        }
+        entry = std::move(slot.entry);
+        slot.sequence.store(dequeuePos + CAPACITY, std::memory_order_release);
+        ++dequeuePos;
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        LogEntry entry;
+    };
+    std::vector<Slot> slots;
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) size_t dequeuePos = 0;
+};
+
+LogQueue queue;
+std::atomic<int> minLevel{Log::LEVEL_INFO};
+std::atomic<unsigned> categoryMask{(1u << Log::CAT_COUNT) - 1};
+std::atomic<bool> running{false};
+std::atomic<bool> writerSleeping{false};
+std::atomic<size_t> droppedCount{0};
+std::thread writerThread;
+std::mutex wakeMutex;
+std::condition_variable wakeCondition;
+std::mutex syncWriteMutex;  // 只用于没有后台线程时的同步写
+
+void formatEntry(std::string& out, const LogEntry& entry) {
+    char prefix[64];
+    std::snprintf(prefix, sizeof(prefix), "[%8.3f][%s][%s] ", entry.timeMs / 1000.0,
+                  Log::getLevelName(entry.level), Log::getCategoryName(entry.category));
+    out += prefix;
+    out += entry.text;
+    out += '\n';
+}
+
+// 一批日志拼成一次 fwrite，警告和错误走 stderr
+void flushBatch(std::string& outBatch, std::string& errBatch) {
+    if (!outBatch.empty()) {
+        std::fwrite(outBatch.data(), 1, outBatch.size(), stdout);
+        std::fflush(stdout);
+        outBatch.clear();
+    }
+    if (!errBatch.empty()) {
+        std::fwrite(errBatch.data(), 1, errBatch.size(), stderr);
+        std::fflush(stderr);
+        errBatch.clear();
+    }
+}
+
+void drainQueue(std::string& outBatch, std::string& errBatch) {
+    LogEntry entry;
+    while (queue.pop(entry)) {
+        formatEntry(entry.level >= Log::LEVEL_WARN ? errBatch : outBatch, entry);
+    }
+    size_t dropped = droppedCount.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+        errBatch += "[log] 日志队列已满，丢弃 " + std::to_string(dropped) + " 条\n";
+    }
+    flushBatch(outBatch, errBatch);
+}
+
+void writerLoop() {
+    std::string outBatch;
+    std::string errBatch;
+    while (running.load(std::memory_order_acquire)) {
+        drainQueue(outBatch, errBatch);
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        writerSleeping.store(true, std::memory_order_release);
+        wakeCondition.wait_for(lock, std::chrono::milliseconds(20));
+        writerSleeping.store(false, std::memory_order_release);
+    }
+    drainQueue(outBatch, errBatch);
+}
+
+// 进程退出时保证后台线程已结束、队列已写完
+struct LogShutdownGuard {
+    ~LogShutdownGuard() { Log::shutdown(); }
+} shutdownGuard;
+
+}  // namespace
+
+void Log::init() {
+    if (running.exchange(true)) {
+        return;
+    }
+    writerThread = std::thread(writerLoop);
+}
+
+void Log::shutdown() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    wakeCondition.notify_one();
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
+}
+
+void Log::setLevel(Level level) {
+    minLevel.store(level, std::memory_order_relaxed);
+}
+
+Log::Level Log::getLevel() {
+    return (Level)minLevel.load(std::memory_order_relaxed);
+}
+
+void Log::setCategoryEnabled(Category category, bool enabled) {
+    if (enabled) {
+        categoryMask.fetch_or(1u << category, std::memory_order_relaxed);
+    } else {
+        categoryMask.fetch_and(~(1u << category), std::memory_order_relaxed);
+    }
+}
+
+bool Log::isEnabled(Level level, Category category) {
+    return level >= minLevel.load(std::memory_order_relaxed) &&
+           (categoryMask.load(std::memory_order_relaxed) & (1u << category)) != 0;
+}
+
+void Log::write(Level level, Category category, std::string message) {
+    LogEntry entry;
+    entry.level = level;
+    entry.category = category;
+    entry.timeMs = SDL_GetTicks();
+    entry.text = std::move(message);
+
+    if (!running.load(std::memory_order_acquire)) {
+        std::string line;
+        formatEntry(line, entry);
+        std::lock_guard<std::mutex> lock(syncWriteMutex);
+        std::FILE* stream = level >= LEVEL_WARN ? stderr : stdout;
+        std::fwrite(line.data(), 1, line.size(), stream);
+        std::fflush(stream);
+        return;
+    }
+
+    if (!queue.push(std::move(entry))) {
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // 错误尽快写出；其余日志等后台线程下一轮（最多 20ms）批量写
+    if (level >= LEVEL_ERROR && writerSleeping.load(std::memory_order_acquire)) {
+        wakeCondition.notify_one();
+    }
+}
+
+bool Log::parseLevel(const std::string& name, Level& level) {
+    static const char* const names[] = {"trace", "debug", "info", "warn", "error", "off"};
+    for (int i = 0; i <= LEVEL_OFF; ++i) {
+        if (name == names[i]) {
+            level = (Level)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* Log::getLevelName(Level level) {
+    switch (level) {
+        case LEVEL_TRACE: return "TRACE";
+        case LEVEL_DEBUG: return "DEBUG";
+        case LEVEL_INFO: return "INFO";
+        case LEVEL_WARN: return "WARN";
+        case LEVEL_ERROR: return "ERROR";
+        case LEVEL_OFF: return "OFF";
+    }
+    return "?";
+}
+
+const char* Log::getCategoryName(Category category) {
+    switch (category) {
+        case CAT_GAME: return "game";
+        case CAT_MAP: return "map";
+        case CAT_PLAYER: return "player";
+        case CAT_CAMERA: return "camera";
+        case CAT_AUDIO: return "audio";
+        case CAT_PERF: return "perf";
+        case CAT_REPLAY: return "replay";
+        case CAT_COUNT: break;
+    }
+    return "?";
+}
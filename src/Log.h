@@ -0,0 +1,101 @@
+#pragma once
+#include <sstream>
+#include <string>
+
+// 分级、分类的异步日志：LOG_xxx 宏在调用线程只格式化字符串并放进无锁队列，
+// 由后台线程批量写到控制台，游戏循环不会被 std::endl 刷新控制台阻塞。
+// 队列满时丢弃新消息并计数，绝不等待。
+// 低于 ECHOGIDGE_LOG_MIN_LEVEL 的级别在编译期去掉（参数表达式不会求值）。
+class Log {
+public:
+    enum Level {
+        LEVEL_TRACE = 0,
+        LEVEL_DEBUG = 1,
+        LEVEL_INFO = 2,
+        LEVEL_WARN = 3,
+        LEVEL_ERROR = 4,
+        LEVEL_OFF = 5
+    };
+
+    enum Category {
+        CAT_GAME,
+        CAT_MAP,
+        CAT_PLAYER,
+        CAT_CAMERA,
+        CAT_AUDIO,
+        CAT_PERF,
+        CAT_REPLAY,
+        CAT_COUNT
+    };
+
+    // 启动后台写线程；启动前和关闭后的日志直接同步写出
+    static void init();
+    // 写完队列中剩余的日志并结束后台线程
+    static void shutdown();
+
+    static void setLevel(Level level);
+    static Level getLevel();
+    static void setCategoryEnabled(Category category, bool enabled);
+    static bool isEnabled(Level level, Category category);
+
+    static void write(Level level, Category category, std::string message);
+
+    static bool parseLevel(const std::string& name, Level& level);
+    static const char* getLevelName(Level level);
+    static const char* getCategoryName(Category category);
+};
+
+#ifndef ECHOGIDGE_LOG_MIN_LEVEL
+#define ECHOGIDGE_LOG_MIN_LEVEL 1
+#endif
+
+#define ECHO_LOG_WRITE(level, category, message)                  \
+    do {                                                          \
+        if (Log::isEnabled(level, Log::category)) {               \
+            std::ostringstream echoLogStream_;                    \
+            echoLogStream_ << message;                            \
+            Log::write(level, Log::category, echoLogStream_.str()); \
+        }                                                         \
+    } while (0)
+
+// 被编译期去掉的级别：表达式放在 if (false) 里，不求值也不产生代码，但仍做类型检查，
+// 只为日志计算的局部变量也不会报未使用警告
+#define ECHO_LOG_DISCARD(category, message)       \
+    do {                                          \
+        if (false) {                              \
+            std::ostringstream echoLogStream_;    \
+            echoLogStream_ << message;            \
+            (void)Log::category;                  \
+        }                                         \
+    } while (0)
+
+// 用法：LOG_INFO(CAT_PLAYER, "玩家位置 " << x << ", " << y);
+#if ECHOGIDGE_LOG_MIN_LEVEL <= 0
+#define LOG_TRACE(category, message) ECHO_LOG_WRITE(Log::LEVEL_TRACE, category, message)
+#else
+#define LOG_TRACE(category, message) ECHO_LOG_DISCARD(category, message)
+#endif
+
+#if ECHOGIDGE_LOG_MIN_LEVEL <= 1
+#define LOG_DEBUG(category, message) ECHO_LOG_WRITE(Log::LEVEL_DEBUG, category, message)
+#else
+#define LOG_DEBUG(category, message) ECHO_LOG_DISCARD(category, message)
+#endif
+
+#if ECHOGIDGE_LOG_MIN_LEVEL <= 2
+#define LOG_INFO(category, message) ECHO_LOG_WRITE(Log::LEVEL_INFO, category, message)
+#else
+#define LOG_INFO(category, message) ECHO_LOG_DISCARD(category, message)
+#endif
+
+#if ECHOGIDGE_LOG_MIN_LEVEL <= 3
+#define LOG_WARN(category, message) ECHO_LOG_WRITE(Log::LEVEL_WARN, category, message)
+#else
+#define LOG_WARN(category, message) ECHO_LOG_DISCARD(category, message)
+#endif
+
+#if ECHOGIDGE_LOG_MIN_LEVEL <= 4
+#define LOG_ERROR(category, message) ECHO_LOG_WRITE(Log::LEVEL_ERROR, category, message)
+#else
+#define LOG_ERROR(category, message) ECHO_LOG_DISCARD(category, message)
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 只读文件的私有内存映射（POSIX mmap / Windows CreateFileMapping）。
+// 映射是写时复制的：可以原地修改映射内容，改动只落在本进程被写到的页上，不会写回文件。
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept { swap(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            swap(other);
+        }
+        return *this;
+    }
+
+    // 失败时返回 false，错误原因见 getError()；空文件视为失败
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return base != nullptr; }
+    uint8_t* data() const { return base; }
+    size_t size() const { return length; }
+    const std::string& getError() const { return error; }
+
+private:
+    void swap(MappedFile& other) noexcept;
+
+    uint8_t* base = nullptr;
+    size_t length = 0;
+    std::string error;
+#ifdef _WIN32
+    void* fileHandle = nullptr;     // HANDLE，避免在头文件里引入 windows.h
+    void* mappingHandle = nullptr;
+#endif
+};
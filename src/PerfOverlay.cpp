@@ -0,0 +1,191 @@
+#include "PerfOverlay.h"
+#include "Log.h"
+#include <algorithm>
+#include <cstdio>
+
+// std::min/max 按引用取参数，类内初始化的静态常量需要定义
+const int PerfOverlay::HISTORY;
+
+PerfOverlay::~PerfOverlay() {
+    cleanup();
+    if (font) {
+        TTF_CloseFont(font);
+        font = nullptr;
+    }
+}
+
+void PerfOverlay::cleanup() {
+    for (auto& line : lines) {
+        if (line.texture) {
+            SDL_DestroyTexture(line.texture);
+        }
+    }
+    lines.clear();
+    lastTextUpdate = 0;
+}
+
+void PerfOverlay::addSample(const Sample& sample) {
+    samples[sampleIndex] = sample;
+    sampleIndex = (sampleIndex + 1) % HISTORY;
+    sampleCount = std::min(sampleCount + 1, HISTORY);
+}
+
+bool PerfOverlay::ensureFont() {
+    if (font || fontFailed) {
+        return font != nullptr;
+    }
+    if (TTF_WasInit() == 0 && TTF_Init() == -1) {
+        LOG_ERROR(CAT_PERF, "性能面板字体初始化失败: " << TTF_GetError());
+        fontFailed = true;
+        return false;
+    }
+    font = TTF_OpenFont("assets/fonts/FLyouzichati-Regular-2.ttf", 12);
+    if (!font) {
+        font = TTF_OpenFont("arial.ttf", 12);
+    }
+    if (!font) {
+        LOG_WARN(CAT_PERF, "性能面板字体加载失败，只显示帧时间图: " << TTF_GetError());
+        fontFailed = true;
+        return false;
+    }
+    return true;
+}
+
+void PerfOverlay::rebuildText(SDL_Renderer* renderer, const SceneInfo& scene) {
+    cleanup();
+    if (!ensureFont() || sampleCount == 0) {
+        return;
+    }
+
+    // 最近一秒左右的平均值和最大帧时间
+    int window = std::min(sampleCount, 60);
+    float frameSum = 0.0f, updateSum = 0.0f, renderSum = 0.0f, frameMax = 0.0f;
+    for (int i = 0; i < window; ++i) {
+        const Sample& s = samples[(sampleIndex - 1 - i + HISTORY) % HISTORY];
+        frameSum += s.frameMs;
+        updateSum += s.updateMs;
+        renderSum += s.renderMs;
+        frameMax = std::max(frameMax, s.frameMs);
+    }
+    float frameAvg = frameSum / window;
+    float updateAvg = updateSum / window;
+    float renderAvg = renderSum / window;
+
+    // CPU 时间占满帧间隔说明瓶颈在 CPU（更新或提交绘制），否则帧时间主要花在等待上
+    const char* bound = "waiting (vsync/cap)";
+    if (updateAvg + renderAvg > frameAvg * 0.8f) {
+        bound = updateAvg > renderAvg ? "CPU: update-bound" : "CPU: draw-bound";
+    }
+
+    char buffer[160];
+    std::vector<std::string> texts;
+    std::snprintf(buffer, sizeof(buffer), "frame %.2f ms (max %.2f)  %.0f FPS", frameAvg, frameMax,
+                  frameAvg > 0.0f ? 1000.0f / frameAvg : 0.0f);
+    texts.push_back(buffer);
+    std::snprintf(buffer, sizeof(buffer), "update %.2f ms (%d steps)  render %.2f ms  -> %s", updateAvg,
+                  scene.simSteps, renderAvg, bound);
+    texts.push_back(buffer);
+    std::snprintf(buffer, sizeof(buffer), "copy %d  geometry %d (%d verts)  tex switches %d",
+                  scene.draws.copyCalls, scene.draws.geometryCalls, scene.draws.geometryVertices,
+                  scene.draws.textureSwitches);
+    texts.push_back(buffer);
+    std::snprintf(buffer, sizeof(buffer), "tiles back %d  main %d  mode %s  chunks %d", scene.visibleBackTiles,
+                  scene.visibleMainTiles, scene.tileRenderMode, scene.residentChunks);
+    texts.push_back(buffer);
+    std::snprintf(buffer, sizeof(buffer), "textures %d  %.1f MB resident", scene.textureCount,
+                  scene.textureBytes / (1024.0 * 1024.0));
+    texts.push_back(buffer);
+
+    SDL_Color color{230, 230, 230, 255};
+    for (const std::string& text : texts) {
+        SDL_Surface* surface = TTF_RenderUTF8_Blended(font, text.c_str(), color);
+        if (!surface) {
+            continue;
+        }
+        TextLine line;
+        line.texture = SDL_CreateTextureFromSurface(renderer, surface);
+        line.w = surface->w;
+        line.h = surface->h;
+        SDL_FreeSurface(surface);
+        if (line.texture) {
+            lines.push_back(line);
+        }
+    }
+    lastTextUpdate = SDL_GetTicks();
+}
+
+void PerfOverlay::drawGraph(SDL_Renderer* renderer, int x, int y) const {
+    const float pxPerMs = GRAPH_HEIGHT / GRAPH_MAX_MS;
+    std::vector<SDL_Rect> updateBars, renderBars, otherBars;
+    updateBars.reserve(sampleCount);
+    renderBars.reserve(sampleCount);
+    otherBars.reserve(sampleCount);
+
+    // 从左到右由旧到新，每帧一列：底部绿色为更新，其上蓝色为渲染，灰色为其余（等待、事件等）
+    for (int i = 0; i < sampleCount; ++i) {
+        const Sample& s = samples[(sampleIndex - sampleCount + i + HISTORY) % HISTORY];
+        int column = x + HISTORY - sampleCount + i;
+        int updateH = (int)(std::min(s.updateMs, GRAPH_MAX_MS) * pxPerMs);
+        int renderH = (int)(std::min(s.renderMs, GRAPH_MAX_MS) * pxPerMs);
+        int frameH = (int)(std::min(s.frameMs, GRAPH_MAX_MS) * pxPerMs);
+        renderH = std::min(renderH, GRAPH_HEIGHT - updateH);
+        int otherH = std::max(0, frameH - updateH - renderH);
+        int bottom = y + GRAPH_HEIGHT;
+        if (updateH > 0) updateBars.push_back({column, bottom - updateH, 1, updateH});
+        if (renderH > 0) renderBars.push_back({column, bottom - updateH - renderH, 1, renderH});
+        if (otherH > 0) otherBars.push_back({column, bottom - updateH - renderH - otherH, 1, otherH});
+    }
+
+    SDL_SetRenderDrawColor(renderer, 120, 120, 120, 255);
+    SDL_RenderFillRects(renderer, otherBars.data(), (int)otherBars.size());
+    SDL_SetRenderDrawColor(renderer, 70, 200, 90, 255);
+    SDL_RenderFillRects(renderer, updateBars.data(), (int)updateBars.size());
+    SDL_SetRenderDrawColor(renderer, 70, 140, 255, 255);
+    SDL_RenderFillRects(renderer, renderBars.data(), (int)renderBars.size());
+
+    // 60 FPS 和 30 FPS 的预算线
+    int line60 = y + GRAPH_HEIGHT - (int)(1000.0f / 60.0f * pxPerMs);
+    int line30 = y + GRAPH_HEIGHT - (int)(1000.0f / 30.0f * pxPerMs);
+    SDL_SetRenderDrawColor(renderer, 255, 220, 0, 255);
+    SDL_RenderDrawLine(renderer, x, line60, x + HISTORY - 1, line60);
+    SDL_SetRenderDrawColor(renderer, 255, 60, 60, 255);
+    SDL_RenderDrawLine(renderer, x, line30, x + HISTORY - 1, line30);
+}
+
+void PerfOverlay::render(SDL_Renderer* renderer, const SceneInfo& scene) {
+    if (!visible) {
+        return;
+    }
+    if (lines.empty() || SDL_GetTicks() - lastTextUpdate >= 250) {
+        rebuildText(renderer, scene);
+    }
+
+    Uint8 r, g, b, a;
+    SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+    SDL_BlendMode prevBlend;
+    SDL_GetRenderDrawBlendMode(renderer, &prevBlend);
+
+    const int padding = 6;
+    int textH = 0;
+    int textW = 0;
+    for (const TextLine& line : lines) {
+        textH += line.h;
+        textW = std::max(textW, line.w);
+    }
+    SDL_Rect panel = {4, 4, std::max(HISTORY, textW) + padding * 2, GRAPH_HEIGHT + textH + padding * 3};
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 170);
+    SDL_RenderFillRect(renderer, &panel);
+
+    drawGraph(renderer, panel.x + padding, panel.y + padding);
+
+    int textY = panel.y + padding * 2 + GRAPH_HEIGHT;
+    for (const TextLine& line : lines) {
+        SDL_Rect dest = {panel.x + padding, textY, line.w, line.h};
+        SDL_RenderCopy(renderer, line.texture, nullptr, &dest);
+        textY += line.h;
+    }
+
+    SDL_SetRenderDrawColor(renderer, r, g, b, a);
+    SDL_SetRenderDrawBlendMode(renderer, prevBlend);
+}
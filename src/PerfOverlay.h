@@ -0,0 +1,67 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <string>
+#include <vector>
+#include "RenderStats.h"
+
+// 游戏内性能面板（F3 开关），画在 HUD 之后：
+// 滚动帧时间图（更新/渲染/其余时间分色叠加），以及每帧绘制调用数、纹理切换数和各层可见瓦片数。
+// 文字每 250ms 才重新生成一次纹理，面板本身的开销保持很小。
+class PerfOverlay {
+public:
+    // 一帧的数据；帧时间是整个帧间隔（含等待垂直同步/限帧），更新和渲染是其中的 CPU 时间
+    struct Sample {
+        float frameMs = 0.0f;
+        float updateMs = 0.0f;
+        float renderMs = 0.0f;
+    };
+
+    // 面板上显示的场景信息，由 Game 每帧填写
+    struct SceneInfo {
+        RenderStats::Counters draws;
+        int visibleBackTiles = 0;
+        int visibleMainTiles = 0;
+        int residentChunks = 0;
+        int textureCount = 0;     // TextureCache 常驻纹理
+        size_t textureBytes = 0;
+        const char* tileRenderMode = "";
+        int simSteps = 0;
+    };
+
+    PerfOverlay() = default;
+    ~PerfOverlay();
+    PerfOverlay(const PerfOverlay&) = delete;
+    PerfOverlay& operator=(const PerfOverlay&) = delete;
+
+    void toggle() { visible = !visible; }
+    bool isVisible() const { return visible; }
+
+    void addSample(const Sample& sample);
+    void render(SDL_Renderer* renderer, const SceneInfo& scene);
+    void cleanup();
+
+private:
+    bool ensureFont();
+    void rebuildText(SDL_Renderer* renderer, const SceneInfo& scene);
+    void drawGraph(SDL_Renderer* renderer, int x, int y) const;
+
+    static const int HISTORY = 240;
+    static const int GRAPH_HEIGHT = 80;
+    static constexpr float GRAPH_MAX_MS = 40.0f;
+
+    bool visible = false;
+    std::vector<Sample> samples = std::vector<Sample>(HISTORY);
+    int sampleIndex = 0;
+    int sampleCount = 0;
+
+    TTF_Font* font = nullptr;
+    bool fontFailed = false;
+    struct TextLine {
+        SDL_Texture* texture = nullptr;
+        int w = 0;
+        int h = 0;
+    };
+    std::vector<TextLine> lines;
+    Uint32 lastTextUpdate = 0;
+};
@@ -1,17 +1,35 @@
 #include "Player.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include "TextureAtlas.h"
+#include "TextureCache.h"
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
-#include <iostream>
 
-Player::Player(SDL_Renderer* renderer) : position(0, 0), velocity(0, 0) {
-    texture = IMG_LoadTexture(renderer, "assets/sprites/player.png");
-    if (!texture) {
-        std::cerr << "玩家纹理加载有问题，先用红色方块代替: " << IMG_GetError() << std::endl;
-        SDL_Surface* surface = SDL_CreateRGBSurface(0, 16, 24, 32, 0, 0, 0, 0);
-        SDL_FillRect(surface, nullptr, SDL_MapRGB(surface->format, 255, 0, 0));
-        texture = SDL_CreateTextureFromSurface(renderer, surface);
-        SDL_FreeSurface(surface);
+PlayerInput PlayerInput::fromKeyboard() {
+    const Uint8* keys = SDL_GetKeyboardState(nullptr);
+    PlayerInput input;
+    input.left = keys[SDL_SCANCODE_LEFT] != 0;
+    input.right = keys[SDL_SCANCODE_RIGHT] != 0;
+    input.jump = keys[SDL_SCANCODE_SPACE] || keys[SDL_SCANCODE_UP];
+    return input;
+}
+
+Player::Player(SDL_Renderer* renderer, const TextureRegion& preloaded)
+    : texture(preloaded.texture), textureSrc(preloaded.src), position(0, 0), previousPosition(0, 0), velocity(0, 0) {
+    if (renderer && !texture) {
+        TextureRegion region;
+        if (TextureAtlas::acquire(renderer, TEXTURE_PATH, region)) {
+            texture = region.texture;
+            textureSrc = region.src;
+        }
+    }
+    if (renderer && !texture) {
+        LOG_WARN(CAT_PLAYER, "玩家纹理加载有问题，先用红色方块代替: " << IMG_GetError());
+        texture = TextureCache::acquireSolid(renderer, DRAW_WIDTH, DRAW_HEIGHT, 255, 0, 0);
+        textureSrc = {0, 0, DRAW_WIDTH, DRAW_HEIGHT};
     }
 
     hitbox = {2, 4, 12, 18};
@@ -19,7 +37,16 @@ Player::Player(SDL_Renderer* renderer) : position(0, 0), velocity(0, 0) {
 }
 
 Player::~Player() {
-    SDL_DestroyTexture(texture);
+    TextureCache::release(texture);
+}
+
+void Player::reset(const glm::vec2& pos) {
+    setPosition(pos);
+    velocity = glm::vec2(0, 0);
+    onGround = false;
+    dead = false;
+    wasOnGround = true;
+    justLanded = false;
 }
 
 void Player::setAudioCallback(std::function<void(const std::string&)> callback) {
@@ -32,30 +59,30 @@ void Player::playSound(const std::string& soundName) {
     }
 }
 
-void Player::handleInput() {
+void Player::handleInput(const PlayerInput& input) {
     if (dead) {
         return;
     }
 
-    const Uint8* keys = SDL_GetKeyboardState(nullptr);
     velocity.x = 0;
 
-    if (keys[SDL_SCANCODE_LEFT]) {
+    if (input.left) {
         velocity.x = -speed;
     }
-    if (keys[SDL_SCANCODE_RIGHT]) {
+    if (input.right) {
         velocity.x = speed;
     }
 
-    if ((keys[SDL_SCANCODE_SPACE] || keys[SDL_SCANCODE_UP]) && onGround) {
+    if (input.jump && onGround) {
         velocity.y = jumpForce;
         onGround = false;
         playSound("jump");
-        std::cout << "玩家起跳，播放jump.wav" << std::endl;
+        LOG_DEBUG(CAT_PLAYER, "玩家起跳，播放jump.wav");
     }
 }
 
 void Player::update(const TiledMap& map, float deltaTime) {
+    PROFILE_SCOPE("Player::update");
     if (dead) {
         return;
     }
@@ -64,67 +91,20 @@ void Player::update(const TiledMap& map, float deltaTime) {
 
     velocity.y += gravity * deltaTime;
 
-    float oldX = position.x;
-    position.x += velocity.x * deltaTime;
-
-    SDL_Point testPoints[4] = {
-        {static_cast<int>(position.x + hitbox.x), static_cast<int>(position.y + hitbox.y)},
-        {static_cast<int>(position.x + hitbox.x + hitbox.w - 1),
-         static_cast<int>(position.y + hitbox.y)},
-        {static_cast<int>(position.x + hitbox.x), static_cast<int>(position.y + hitbox.y + hitbox.h - 1)},
-        {static_cast<int>(position.x + hitbox.x + hitbox.w - 1),
-         static_cast<int>(position.y + hitbox.y + hitbox.h - 1)}};
-
-    bool collideX = false;
-    for (int i = 0; i < 4; i++) {
-        if (map.isColliding(testPoints[i].x, testPoints[i].y)) {
-            collideX = true;
-            break;
-        }
-    }
-
-    if (collideX) {
-        position.x = oldX;
+    // 扫掠碰撞：先 X 后 Y，只检查碰撞盒前沿扫过的格子，任意步长都不会穿过薄地板
+    TiledMap::SweepResult sweepX = map.sweepX(getWorldBox(), velocity.x * deltaTime);
+    position.x += sweepX.distance;
+    if (sweepX.hit) {
         velocity.x = 0;
     }
 
-    float oldY = position.y;
-    position.y += velocity.y * deltaTime;
-
-    SDL_Point testPointsY[4] = {
-        {static_cast<int>(position.x + hitbox.x), static_cast<int>(position.y + hitbox.y)},
-        {static_cast<int>(position.x + hitbox.x + hitbox.w - 1),
-         static_cast<int>(position.y + hitbox.y)},
-        {static_cast<int>(position.x + hitbox.x), static_cast<int>(position.y + hitbox.y + hitbox.h - 1)},
-        {static_cast<int>(position.x + hitbox.x + hitbox.w - 1),
-         static_cast<int>(position.y + hitbox.y + hitbox.h - 1)}};
-
-    bool collideY = false;
-    bool collideTop = false;
-    bool collideBottom = false;
-
-    for (int i = 0; i < 4; i++) {
-        if (map.isColliding(testPointsY[i].x, testPointsY[i].y)) {
-            collideY = true;
-            if (i < 2) {
-                collideTop = true;
-            } else {
-                collideBottom = true;
-            }
-        }
-    }
-
-    if (collideY) {
-        if (collideBottom && velocity.y > 0) {
+    TiledMap::SweepResult sweepY = map.sweepY(getWorldBox(), velocity.y * deltaTime);
+    position.y += sweepY.distance;
+    if (sweepY.hit) {
+        if (velocity.y > 0) {
             onGround = true;
-            float worldY = position.y + hitbox.y + hitbox.h;
-            int tileY = static_cast<int>(worldY) / map.getTileHeight();
-            position.y = (tileY * map.getTileHeight()) - hitbox.y - hitbox.h;
-            velocity.y = 0;
-        } else if (collideTop && velocity.y < 0) {
-            position.y = oldY;
-            velocity.y = 0;
         }
+        velocity.y = 0;
     } else {
         onGround = false;
     }
@@ -135,7 +115,7 @@ void Player::update(const TiledMap& map, float deltaTime) {
         // 300ms 冷却，避免落地音效一直在响
         if (currentTime - lastHurtTime > 300) {
             playSound("hurt");
-            std::cout << "播放落地音效 (速度: " << velocity.y << ")" << std::endl;
+            LOG_DEBUG(CAT_PLAYER, "播放落地音效 (速度: " << velocity.y << ")");
             lastHurtTime = currentTime;
         }
     }
@@ -166,37 +146,31 @@ void Player::checkCollisionsWithHazards(const TiledMap& map) {
         return;
     }
 
-    SDL_Point testPoints[4] = {
-        {static_cast<int>(position.x + hitbox.x), static_cast<int>(position.y + hitbox.y)},
-        {static_cast<int>(position.x + hitbox.x + hitbox.w - 1),
-         static_cast<int>(position.y + hitbox.y)},
-        {static_cast<int>(position.x + hitbox.x), static_cast<int>(position.y + hitbox.y + hitbox.h - 1)},
-        {static_cast<int>(position.x + hitbox.x + hitbox.w - 1),
-         static_cast<int>(position.y + hitbox.y + hitbox.h - 1)}};
-
-    for (int i = 0; i < 4; i++) {
-        if (map.isHazard(testPoints[i].x, testPoints[i].y)) {
-            std::cout << "玩家死亡，碰上了危险碰撞点 " << i << " ("
-                      << testPoints[i].x << ", " << testPoints[i].y << ")" << std::endl;
-            kill();
-            return;
-        }
+    SDL_Rect rect = getWorldRect();
+    if (map.queryRect(rect).flags & TiledMap::TILE_HAZARD) {
+        LOG_INFO(CAT_PLAYER, "玩家死亡，碰上了危险区域 (" << rect.x << ", " << rect.y << ", "
+                             << rect.w << "x" << rect.h << ")");
+        kill();
     }
 }
 
-void Player::render(SDL_Renderer* renderer, const Camera& camera, float renderScale) {
+void Player::render(SDL_Renderer* renderer, const Camera& camera, float renderScale, float alpha) {
+    if (!texture) {
+        return;
+    }
     if (dead) {
         SDL_SetTextureAlphaMod(texture, 128);
     }
 
     const SDL_Rect& view = camera.getView();
+    glm::vec2 drawPos = previousPosition + (position - previousPosition) * alpha;
 
-    SDL_Rect dest = {static_cast<int>(position.x * renderScale - view.x),
-                     static_cast<int>(position.y * renderScale - view.y),
-                     static_cast<int>(16 * renderScale),
-                     static_cast<int>(24 * renderScale)};
+    SDL_Rect dest = {static_cast<int>(drawPos.x * renderScale - view.x),
+                     static_cast<int>(drawPos.y * renderScale - view.y),
+                     static_cast<int>(DRAW_WIDTH * renderScale),
+                     static_cast<int>(DRAW_HEIGHT * renderScale)};
 
-    SDL_RenderCopy(renderer, texture, nullptr, &dest);
+    RenderStats::copy(renderer, texture, &textureSrc, &dest);
 
     if (dead) {
         SDL_SetTextureAlphaMod(texture, 255);
@@ -5,15 +5,36 @@
 #include "TiledMap.h"
 #include "Camera.h"
 
+// 一个模拟步的玩家输入，键盘、无界面自动驾驶等输入源都先转换成它
+struct PlayerInput {
+    bool left = false;
+    bool right = false;
+    bool jump = false;
+
+    static PlayerInput fromKeyboard();
+};
+
 class Player {
 public:
-    Player(SDL_Renderer* renderer);
+    static constexpr const char* TEXTURE_PATH = "assets/sprites/player.png";
+    // 绘制尺寸（乘 renderScale 之前），纹理按它降采样
+    static constexpr int DRAW_WIDTH = 16;
+    static constexpr int DRAW_HEIGHT = 24;
+
+    // renderer 为空时不加载纹理（无界面模拟）；preloaded 为预先加载好的玩家图片（接管这个 TextureCache 引用），
+    // 为空时自己加载到图集
+    Player(SDL_Renderer* renderer, const TextureRegion& preloaded = TextureRegion());
     ~Player();
-    void handleInput();
+    void handleInput(const PlayerInput& input);
     void update(const TiledMap& map, float deltaTime);
-    void render(SDL_Renderer* renderer, const Camera& camera, float renderScale = 1.0f);
+    // alpha 为上一个与当前模拟状态之间的插值系数（固定步长模拟 + 渲染插值）
+    void render(SDL_Renderer* renderer, const Camera& camera, float renderScale = 1.0f, float alpha = 1.0f);
     glm::vec2 getPosition() const { return position; }
-    void setPosition(const glm::vec2& pos) { position = pos; }
+    void setPosition(const glm::vec2& pos) {
+        position = pos;
+        previousPosition = pos;
+    }
+    void savePreviousPosition() { previousPosition = position; }
  
     SDL_Rect getWorldRect() const {
         return SDL_Rect{
@@ -23,17 +44,24 @@ public:
         };
     }
 
+    SDL_FRect getWorldBox() const {
+        return SDL_FRect{position.x + hitbox.x, position.y + hitbox.y, (float)hitbox.w, (float)hitbox.h};
+    }
+
     // 修改：使用 std::function
     void setAudioCallback(std::function<void(const std::string&)> callback);
     
     bool isDead() const { return dead; }
     void kill() { dead = true; }
     void respawn() { dead = false; }
+    void reset(const glm::vec2& pos);  // 新游戏复用同一个玩家：回到初始状态，纹理保留
     void checkCollisionsWithHazards(const TiledMap& map);
 
 private:
     SDL_Texture* texture = nullptr;
+    SDL_Rect textureSrc = {0, 0, 0, 0};  // 玩家图片在图集页中的位置
     glm::vec2 position;
+    glm::vec2 previousPosition;  // 上一个模拟步的位置，用于渲染插值
     glm::vec2 velocity;
     SDL_Rect hitbox;
     bool onGround = false;
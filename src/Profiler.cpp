@@ -0,0 +1,137 @@
+#include "Profiler.h"
+#include "Log.h"
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct ProfileEvent {
+    const char* name;
+    Uint64 start;
+    Uint64 duration;
+};
+
+// 单生产者环形缓冲：只有所属线程写，导出时其他线程按 writeIndex 读取
+struct ThreadBuffer {
+    static const size_t CAPACITY = 1 << 16;  // 约 1.5MB，60 FPS 下大约能存最近 30 秒
+    std::vector<ProfileEvent> events = std::vector<ProfileEvent>(CAPACITY);
+    std::atomic<uint64_t> writeIndex{0};
+    int threadId = 0;
+    std::string threadName;
+};
+
+// 缓冲只在线程第一次记录时注册，之后永不释放，线程退出后仍然可以导出
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;
+std::atomic<bool> profilerEnabled{true};
+const Uint64 epochCounter = SDL_GetPerformanceCounter();
+
+thread_local ThreadBuffer* currentBuffer = nullptr;
+thread_local std::string currentThreadName;  // setThreadName 早于第一次记录时先存在这里
+
+ThreadBuffer& threadBuffer() {
+    if (!currentBuffer) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.push_back(std::make_unique<ThreadBuffer>());
+        currentBuffer = registry.back().get();
+        currentBuffer->threadId = (int)registry.size();
+        currentBuffer->threadName = currentThreadName.empty() ? "thread " + std::to_string(currentBuffer->threadId)
+                                                              : currentThreadName;
+    }
+    return *currentBuffer;
+}
+
+void writeJsonString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if ((unsigned char)c < 0x20) {
+            out << ' ';
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+}  // namespace
+
+void Profiler::record(const char* name, Uint64 startCounter, Uint64 endCounter) {
+    if (!profilerEnabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    ThreadBuffer& buffer = threadBuffer();
+    uint64_t index = buffer.writeIndex.load(std::memory_order_relaxed);
+    buffer.events[index & (ThreadBuffer::CAPACITY - 1)] = {name, startCounter, endCounter - startCounter};
+    buffer.writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const char* name) {
+    currentThreadName = name;
+    // 还没记录过的线程等第一次记录时再注册缓冲，只命名不记录的线程不占缓冲
+    if (currentBuffer) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        currentBuffer->threadName = name;
+    }
+}
+
+void Profiler::setEnabled(bool enabled) {
+    profilerEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool Profiler::isEnabled() {
+    return profilerEnabled.load(std::memory_order_relaxed);
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        LOG_ERROR(CAT_PERF, "无法写入性能追踪文件: " << path);
+        return false;
+    }
+
+    const double toMicros = 1000000.0 / (double)SDL_GetPerformanceFrequency();
+    size_t written = 0;
+
+    out << std::fixed << std::setprecision(3);  // 微秒，长时间运行也不能用科学计数法
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& buffer : registry) {
+        if (!first) out << ",";
+        first = false;
+        out << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+            << ",\"args\":{\"name\":";
+        writeJsonString(out, buffer->threadName);
+        out << "}}";
+
+        // 只导出还留在环形缓冲里的部分；导出期间被覆盖的最旧几条可能不完整，可以忽略
+        uint64_t end = buffer->writeIndex.load(std::memory_order_acquire);
+        uint64_t begin = end > ThreadBuffer::CAPACITY ? end - ThreadBuffer::CAPACITY : 0;
+        for (uint64_t i = begin; i < end; ++i) {
+            const ProfileEvent& event = buffer->events[i & (ThreadBuffer::CAPACITY - 1)];
+            if (!event.name || event.start < epochCounter) {
+                continue;
+            }
+            out << ",\n{\"name\":";
+            writeJsonString(out, event.name);
+            out << ",\"cat\":\"game\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                << ",\"ts\":" << (double)(event.start - epochCounter) * toMicros
+                << ",\"dur\":" << (double)event.duration * toMicros << "}";
+            ++written;
+        }
+    }
+    out << "\n]}\n";
+
+    if (!out) {
+        LOG_ERROR(CAT_PERF, "性能追踪文件写入失败: " << path);
+        return false;
+    }
+    LOG_INFO(CAT_PERF, "性能追踪已导出: " << path << " (" << written << " 个事件)");
+    return true;
+}
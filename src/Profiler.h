@@ -0,0 +1,38 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <string>
+
+// 热点路径分段计时：PROFILE_SCOPE("名字") 在作用域结束时把 (名字, 开始, 时长) 写进当前线程自己的环形缓冲。
+// 每个线程只写自己的缓冲，写入不加锁；缓冲写满后覆盖最旧的事件。
+// writeChromeTrace 导出 Chrome trace_event JSON，可用 chrome://tracing 或 Perfetto 打开。
+// CMake 选项 ECHOGIDGE_PROFILER 关闭时宏展开为空，不产生任何开销。
+class Profiler {
+public:
+    // name 必须是静态生命周期的字符串（通常是字面量），缓冲里只存指针
+    static void record(const char* name, Uint64 startCounter, Uint64 endCounter);
+    static void setThreadName(const char* name);  // trace 里显示的线程名，没设置的线程显示为 "thread N"
+    static bool writeChromeTrace(const std::string& path);
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* scopeName) : name(scopeName), start(SDL_GetPerformanceCounter()) {}
+    ~ProfileScope() { Profiler::record(name, start, SDL_GetPerformanceCounter()); }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    Uint64 start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef ECHOGIDGE_PROFILER
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
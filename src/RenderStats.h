@@ -0,0 +1,56 @@
+#pragma once
+#include <SDL2/SDL.h>
+
+// 一帧内的绘制计数
+struct RenderCounters {
+    int copyCalls = 0;        // SDL_RenderCopy + SDL_RenderCopyEx
+    int geometryCalls = 0;    // SDL_RenderGeometry
+    int geometryVertices = 0;
+    int textureSwitches = 0;  // 与上一次绘制使用的纹理不同的次数
+};
+
+// SDL 绘制调用的薄封装：TiledMap、CoinManager、Player 和 HUD 都通过它绘制，
+// 顺便统计每帧 RenderCopy / RenderGeometry 调用次数和纹理切换次数，供性能面板显示。
+// 渲染只在主线程进行，计数用普通静态变量即可。
+class RenderStats {
+public:
+    using Counters = RenderCounters;
+
+    static void beginFrame() {
+        current = Counters{};
+        lastTexture = nullptr;
+    }
+    static const Counters& getCurrent() { return current; }
+
+    static int copy(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect* dst) {
+        ++current.copyCalls;
+        noteTexture(texture);
+        return SDL_RenderCopy(renderer, texture, src, dst);
+    }
+
+    static int copyEx(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect* dst,
+                      double angle, const SDL_Point* center, SDL_RendererFlip flip) {
+        ++current.copyCalls;
+        noteTexture(texture);
+        return SDL_RenderCopyEx(renderer, texture, src, dst, angle, center, flip);
+    }
+
+    static int geometry(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Vertex* vertices, int numVertices,
+                        const int* indices, int numIndices) {
+        ++current.geometryCalls;
+        current.geometryVertices += numVertices;
+        noteTexture(texture);
+        return SDL_RenderGeometry(renderer, texture, vertices, numVertices, indices, numIndices);
+    }
+
+private:
+    static void noteTexture(SDL_Texture* texture) {
+        if (texture != lastTexture) {
+            ++current.textureSwitches;
+            lastTexture = texture;
+        }
+    }
+
+    static inline Counters current;
+    static inline SDL_Texture* lastTexture = nullptr;
+};
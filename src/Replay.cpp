@@ -0,0 +1,259 @@
+#include "Replay.h"
+#include "Log.h"
+#include <cstring>
+#include <iterator>
+
+namespace {
+
+const char REPLAY_MAGIC[4] = {'E', 'G', 'R', 'P'};
+const uint8_t REPLAY_VERSION = 1;
+
+uint32_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bitsToFloat(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// 顺序读取内存中的回放数据，越界时置 failed
+struct ByteReader {
+    const std::vector<uint8_t>& data;
+    size_t pos = 0;
+    bool failed = false;
+
+    bool atEnd() const { return pos >= data.size(); }
+
+    uint8_t byte() {
+        if (pos >= data.size()) {
+            failed = true;
+            return 0;
+        }
+        return data[pos++];
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = byte();
+            value |= (uint64_t)(b & 0x7F) << shift;
+            if (!(b & 0x80)) {
+                return value;
+            }
+        }
+        failed = true;
+        return 0;
+    }
+
+    uint32_t u32() {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= (uint32_t)byte() << (8 * i);
+        }
+        return value;
+    }
+};
+
+}  // namespace
+
+uint8_t packPlayerInput(const PlayerInput& input) {
+    return (input.left ? 1 : 0) | (input.right ? 2 : 0) | (input.jump ? 4 : 0);
+}
+
+ReplayRecorder::~ReplayRecorder() {
+    if (file.is_open()) {
+        // 正常退出时 Game 会调用 finish；这里只保证已录的输入落盘
+        flushRun();
+        file.close();
+    }
+}
+
+bool ReplayRecorder::open(const std::string& path, int tickRate, const std::string& mapPath) {
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        LOG_ERROR(CAT_REPLAY, "无法创建回放文件: " << path);
+        return false;
+    }
+    filePath = path;
+    runBits = 0;
+    runLength = 0;
+    bytesWritten = 0;
+
+    file.write(REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    bytesWritten += sizeof(REPLAY_MAGIC);
+    writeByte(REPLAY_VERSION);
+    writeVarint((uint64_t)tickRate);
+    writeVarint(mapPath.size());
+    file.write(mapPath.data(), (std::streamsize)mapPath.size());
+    bytesWritten += mapPath.size();
+    LOG_INFO(CAT_REPLAY, "开始录制回放: " << path);
+    return true;
+}
+
+void ReplayRecorder::recordTick(const PlayerInput& input) {
+    if (!file.is_open()) return;
+    uint8_t bits = packPlayerInput(input);
+    if (runLength > 0 && bits != runBits) {
+        flushRun();
+    }
+    runBits = bits;
+    ++runLength;
+}
+
+void ReplayRecorder::recordMenuChoice(int choice) {
+    if (!file.is_open()) return;
+    flushRun();
+    writeByte((uint8_t)(REPLAY_MENU << 5));
+    writeByte((uint8_t)choice);
+}
+
+void ReplayRecorder::recordEsc() {
+    if (!file.is_open()) return;
+    flushRun();
+    writeByte((uint8_t)(REPLAY_ESC << 5));
+}
+
+void ReplayRecorder::finish(const ReplayEndState& end) {
+    if (!file.is_open()) return;
+    flushRun();
+    writeByte((uint8_t)(REPLAY_END << 5));
+    writeVarint(end.ticks);
+    writeVarint(end.score);
+    writeU32(floatBits(end.playerX));
+    writeU32(floatBits(end.playerY));
+    file.close();
+    LOG_INFO(CAT_REPLAY, "回放已保存: " << filePath << " (" << end.ticks << " 步, " << bytesWritten << " 字节)");
+}
+
+void ReplayRecorder::flushRun() {
+    if (runLength == 0) return;
+    writeByte((uint8_t)((REPLAY_TICK << 5) | runBits));
+    writeVarint(runLength);
+    runLength = 0;
+}
+
+void ReplayRecorder::writeByte(uint8_t value) {
+    file.put((char)value);
+    ++bytesWritten;
+}
+
+void ReplayRecorder::writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+        writeByte((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    writeByte((uint8_t)value);
+}
+
+void ReplayRecorder::writeU32(uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        writeByte((uint8_t)(value >> (8 * i)));
+    }
+}
+
+bool ReplayPlayer::load(const std::string& path, int expectedTickRate) {
+    loaded = false;
+    hasEnd = false;
+    records.clear();
+    cursor = 0;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        LOG_ERROR(CAT_REPLAY, "无法打开回放文件: " << path);
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    ByteReader reader{data};
+    char magic[4];
+    for (char& c : magic) {
+        c = (char)reader.byte();
+    }
+    if (reader.failed || std::memcmp(magic, REPLAY_MAGIC, sizeof(magic)) != 0) {
+        LOG_ERROR(CAT_REPLAY, "不是回放文件: " << path);
+        return false;
+    }
+    uint8_t version = reader.byte();
+    if (version != REPLAY_VERSION) {
+        LOG_ERROR(CAT_REPLAY, "不支持的回放版本 " << (int)version << ": " << path);
+        return false;
+    }
+    uint64_t tickRate = reader.varint();
+    if ((int)tickRate != expectedTickRate) {
+        LOG_ERROR(CAT_REPLAY, "回放的模拟频率 " << tickRate << " Hz 与当前 " << expectedTickRate
+                              << " Hz 不一致，无法确定性回放");
+        return false;
+    }
+    uint64_t pathLength = reader.varint();
+    if (reader.failed || pathLength > data.size() - reader.pos) {
+        LOG_ERROR(CAT_REPLAY, "回放文件头损坏: " << path);
+        return false;
+    }
+    mapPath.assign((const char*)data.data() + reader.pos, (size_t)pathLength);
+    reader.pos += (size_t)pathLength;
+
+    uint64_t totalTicks = 0;
+    while (!reader.atEnd() && !hasEnd) {
+        uint8_t head = reader.byte();
+        Record record;
+        record.type = (ReplayRecordType)(head >> 5);
+        switch (record.type) {
+            case REPLAY_TICK:
+                record.value = head & 0x07;
+                record.count = reader.varint();
+                totalTicks += record.count;
+                if (record.count > 0) {
+                    records.push_back(record);
+                }
+                break;
+            case REPLAY_MENU:
+                record.value = reader.byte();
+                records.push_back(record);
+                break;
+            case REPLAY_ESC:
+                records.push_back(record);
+                break;
+            case REPLAY_END:
+                endState.ticks = reader.varint();
+                endState.score = reader.varint();
+                endState.playerX = bitsToFloat(reader.u32());
+                endState.playerY = bitsToFloat(reader.u32());
+                hasEnd = true;
+                break;
+            default:
+                reader.failed = true;
+                break;
+        }
+        if (reader.failed) {
+            LOG_ERROR(CAT_REPLAY, "回放数据损坏（偏移 " << reader.pos << "）: " << path);
+            return false;
+        }
+    }
+
+    loaded = true;
+    LOG_INFO(CAT_REPLAY, "载入回放: " << path << " (" << records.size() << " 条记录, " << totalTicks << " 步"
+                         << (hasEnd ? "" : ", 没有结束记录，可能是异常退出时录的") << ")");
+    return true;
+}
+
+void ReplayPlayer::consume() {
+    if (!isPlaying()) return;
+    Record& record = records[cursor];
+    if (record.type == REPLAY_TICK && record.count > 1) {
+        --record.count;
+        return;
+    }
+    ++cursor;
+}
+
+PlayerInput ReplayPlayer::toInput(uint8_t bits) {
+    PlayerInput input;
+    input.left = (bits & 1) != 0;
+    input.right = (bits & 2) != 0;
+    input.jump = (bits & 4) != 0;
+    return input;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Player.h"
+
+// 输入录制/回放（.egrp 二进制格式，小端）：
+//   头部: "EGRP" | 版本(u8) | 模拟频率(varint) | 地图路径长度(varint) + 路径
+//   记录: 1 字节 (类型 << 5 | 负载)
+//     REPLAY_TICK: 负载为输入位（左=1 右=2 跳=4），后跟连续相同输入的步数(varint)
+//     REPLAY_MENU: 后跟菜单选择(u8)
+//     REPLAY_ESC:  无附加数据
+//     REPLAY_END:  后跟总步数(varint)、得分(varint)、玩家最终 x/y(float 位模式, u32)
+// 每个模拟步的输入按游程编码，一分钟按住右键只占几个字节。
+enum ReplayRecordType : uint8_t {
+    REPLAY_TICK = 0,
+    REPLAY_MENU = 1,
+    REPLAY_ESC = 2,
+    REPLAY_END = 3
+};
+
+struct ReplayEndState {
+    uint64_t ticks = 0;
+    uint64_t score = 0;
+    float playerX = 0.0f;
+    float playerY = 0.0f;
+};
+
+class ReplayRecorder {
+public:
+    ~ReplayRecorder();
+
+    bool open(const std::string& path, int tickRate, const std::string& mapPath);
+    bool isRecording() const { return file.is_open(); }
+
+    void recordTick(const PlayerInput& input);
+    void recordMenuChoice(int choice);
+    void recordEsc();
+    void finish(const ReplayEndState& end);
+
+private:
+    void flushRun();
+    void writeByte(uint8_t value);
+    void writeVarint(uint64_t value);
+    void writeU32(uint32_t value);
+
+    std::ofstream file;
+    std::string filePath;
+    uint8_t runBits = 0;
+    uint64_t runLength = 0;
+    uint64_t bytesWritten = 0;
+};
+
+class ReplayPlayer {
+public:
+    struct Record {
+        ReplayRecordType type = REPLAY_TICK;
+        uint8_t value = 0;   // TICK 为输入位，MENU 为菜单选择
+        uint64_t count = 0;  // TICK 的剩余步数
+    };
+
+    // 一次性读入并校验整个文件，格式错误时返回 false 并打印原因
+    bool load(const std::string& path, int expectedTickRate);
+    bool isPlaying() const { return loaded && cursor < records.size(); }
+
+    // 下一条记录（TICK 记录的 count 为本游程剩余步数），回放结束时返回 nullptr
+    const Record* peek() const { return isPlaying() ? &records[cursor] : nullptr; }
+    void consume();  // TICK 记录消耗一步，其余记录整条消耗
+    static PlayerInput toInput(uint8_t bits);
+
+    bool hasEndState() const { return hasEnd; }
+    const ReplayEndState& getEndState() const { return endState; }
+    const std::string& getMapPath() const { return mapPath; }
+
+private:
+    std::vector<Record> records;
+    size_t cursor = 0;
+    bool loaded = false;
+    bool hasEnd = false;
+    ReplayEndState endState;
+    std::string mapPath;
+};
+
+uint8_t packPlayerInput(const PlayerInput& input);
@@ -1,6 +1,6 @@
 #include "StartMenu.h"
-
-#include <iostream>
+#include "Log.h"
+#include "TextureCache.h"
 
 StartMenu::StartMenu(SDL_Renderer* rend) : renderer(rend) {}
 
@@ -8,19 +8,20 @@ StartMenu::~StartMenu() {
     cleanup();
 }
 
-bool StartMenu::init() {
+bool StartMenu::init(SDL_Texture* background) {
     if (TTF_Init() == -1) {
-        std::cerr << "SDL_ttf 初始化失败: " << TTF_GetError() << std::endl;
+        LOG_ERROR(CAT_GAME, "SDL_ttf 初始化失败: " << TTF_GetError());
         return false;
     }
 
-    if (!loadBackground()) {
-        std::cerr << "背景图加载失败，使用纯色背景" << std::endl;
+    backgroundTexture = background;
+    if (!backgroundTexture && !loadBackground()) {
+        LOG_WARN(CAT_GAME, "背景图加载失败，使用纯色背景");
     }
 
     loadFont();
     if (!font) {
-        std::cerr << "字体加载失败" << std::endl;
+        LOG_ERROR(CAT_GAME, "字体加载失败");
         return false;
     }
 
@@ -38,10 +39,18 @@ bool StartMenu::init() {
     return true;
 }
 
+TextureCache::Lod StartMenu::backgroundLod(SDL_Renderer* renderer) {
+    int w = 0, h = 0;
+    if (!renderer || SDL_GetRendererOutputSize(renderer, &w, &h) != 0) {
+        return TextureCache::Lod();
+    }
+    return TextureCache::Lod::stretch(w, h);
+}
+
 bool StartMenu::loadBackground() {
-    backgroundTexture = IMG_LoadTexture(renderer, "assets/menu/background.png");
+    backgroundTexture = TextureCache::acquire(renderer, BACKGROUND_PATH, backgroundLod(renderer));
     if (!backgroundTexture) {
-        std::cerr << "无法加载背景图: " << IMG_GetError() << std::endl;
+        LOG_ERROR(CAT_GAME, "无法加载背景图: " << IMG_GetError());
         return false;
     }
     return true;
@@ -52,7 +61,7 @@ void StartMenu::loadFont() {
     if (!font) {
         font = TTF_OpenFont("arial.ttf", 32);
         if (!font) {
-            std::cerr << "无法加载字体" << std::endl;
+            LOG_ERROR(CAT_GAME, "无法加载字体");
         }
     }
 }
@@ -167,7 +176,7 @@ void StartMenu::render() {
 }
 
 int StartMenu::run() {
-    std::cout << "开始菜单启动" << std::endl;
+    LOG_INFO(CAT_GAME, "开始菜单启动");
 
     while (!quitMenu) {
         handleEvents();
@@ -175,7 +184,7 @@ int StartMenu::run() {
         SDL_Delay(16);
     }
 
-    std::cout << "菜单选择: " << currentSelection << std::endl;
+    LOG_INFO(CAT_GAME, "菜单选择: " << currentSelection);
 
     switch (currentSelection) {
         case 0:
@@ -190,10 +199,8 @@ int StartMenu::run() {
 }
 
 void StartMenu::cleanup() {
-    if (backgroundTexture) {
-        SDL_DestroyTexture(backgroundTexture);
-        backgroundTexture = nullptr;
-    }
+    TextureCache::release(backgroundTexture);
+    backgroundTexture = nullptr;
 
     for (auto& item : menuItems) {
         if (item.texture) {
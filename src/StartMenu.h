@@ -4,15 +4,22 @@
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
 
+#include "TextureCache.h"
+
 #include <string>
 #include <vector>
 
 class StartMenu {
 public:
+    static constexpr const char* BACKGROUND_PATH = "assets/menu/background.png";
+    // 背景拉伸铺满窗口，按渲染器输出尺寸降采样即可
+    static TextureCache::Lod backgroundLod(SDL_Renderer* renderer);
+
     StartMenu(SDL_Renderer* renderer);
     ~StartMenu();
 
-    bool init();
+    // background 为调用方预先加载好的背景图（接管这个 TextureCache 引用），为空时自己加载 BACKGROUND_PATH
+    bool init(SDL_Texture* background = nullptr);
     int run();  // 返回用户选择
     void cleanup();
     void reset();  // 重置选项状态
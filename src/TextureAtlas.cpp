@@ -0,0 +1,305 @@
+#include "TextureAtlas.h"
+#include "Log.h"
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// skyline：每页记录从左到右的一串水平线段，新图片放在能让它底边最低的位置
+struct SkylineNode {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+};
+
+struct Page {
+    SDL_Renderer* renderer = nullptr;
+    SDL_Texture* texture = nullptr;
+    int size = 0;
+    std::vector<SkylineNode> skyline;
+    size_t usedPixels = 0;
+};
+
+std::vector<Page> pages;
+std::map<std::pair<SDL_Renderer*, std::string>, TextureRegion> byKey;
+// 按内容哈希找已打包的图片；另记源文件字节数和像素格式，哈希命中时和尺寸一起核对
+struct HashedRegion {
+    TextureRegion region;
+    size_t sourceBytes = 0;
+    Uint32 format = 0;
+};
+std::map<std::pair<SDL_Renderer*, uint64_t>, HashedRegion> byHash;
+
+// 把 w x h 放在第 index 段起点时的 y，放不下返回 -1
+int fitAt(const Page& page, size_t index, int w, int h) {
+    const std::vector<SkylineNode>& skyline = page.skyline;
+    if (skyline[index].x + w > page.size) return -1;
+    int y = 0;
+    int remaining = w;
+    for (size_t i = index; remaining > 0 && i < skyline.size(); ++i) {
+        y = std::max(y, skyline[i].y);
+        if (y + h > page.size) return -1;
+        remaining -= skyline[i].width;
+    }
+    return y;
+}
+
+// 底边最低优先，一样低时选更窄的线段，减少浪费
+bool packInto(Page& page, int w, int h, SDL_Point& position) {
+    std::vector<SkylineNode>& skyline = page.skyline;
+    int bestIndex = -1;
+    int bestBottom = INT_MAX;
+    int bestWidth = INT_MAX;
+    for (size_t i = 0; i < skyline.size(); ++i) {
+        const int y = fitAt(page, i, w, h);
+        if (y < 0) continue;
+        if (y + h < bestBottom || (y + h == bestBottom && skyline[i].width < bestWidth)) {
+            bestIndex = (int)i;
+            bestBottom = y + h;
+            bestWidth = skyline[i].width;
+        }
+    }
+    if (bestIndex < 0) return false;
+
+    const SkylineNode node = {skyline[bestIndex].x, bestBottom, w};
+    position = {node.x, bestBottom - h};
+    skyline.insert(skyline.begin() + bestIndex, node);
+
+    // 新线段盖住的部分从后面的线段里去掉
+    for (size_t i = bestIndex + 1; i < skyline.size();) {
+        SkylineNode& next = skyline[i];
+        const int covered = node.x + node.width - next.x;
+        if (covered <= 0) break;
+        if (next.width <= covered) {
+            skyline.erase(skyline.begin() + i);
+            continue;
+        }
+        next.x += covered;
+        next.width -= covered;
+        break;
+    }
+    // 合并等高的相邻线段
+    for (size_t i = 0; i + 1 < skyline.size();) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        } else {
+            ++i;
+        }
+    }
+    page.usedPixels += (size_t)w * h;
+    return true;
+}
+
+// 面积不小于 pixels、边长不小于 minSide 的最小 2 的幂边长，限制在 [MIN_PAGE_SIZE, PAGE_SIZE]
+int pageSizeFor(size_t pixels, int minSide = 0) {
+    int size = TextureAtlas::MIN_PAGE_SIZE;
+    while (size < TextureAtlas::PAGE_SIZE && ((size_t)size * size < pixels || size < minSide)) {
+        size *= 2;
+    }
+    return size;
+}
+
+Page* createPage(SDL_Renderer* renderer, int size, std::string& error) {
+    SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, size, size);
+    if (!texture) {
+        error = SDL_GetError();
+        return nullptr;
+    }
+    // 新纹理内容未定义，先整页清成透明
+    std::vector<uint8_t> clear((size_t)size * size * 4, 0);
+    SDL_UpdateTexture(texture, nullptr, clear.data(), size * 4);
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+    Page page;
+    page.renderer = renderer;
+    page.size = size;
+    page.texture = TextureCache::adopt(renderer, "@atlas/" + std::to_string(pages.size()), texture);
+    page.skyline.push_back({0, 0, size});
+    pages.push_back(std::move(page));
+    LOG_DEBUG(CAT_PERF, "TextureAtlas: new page " << pages.size() - 1 << " (" << size << "x" << size << ")");
+    return &pages.back();
+}
+
+}  // namespace
+
+bool TextureAtlas::fits(int w, int h) {
+    return w > 0 && h > 0 && w <= MAX_PACKED_SIZE && h <= MAX_PACKED_SIZE;
+}
+
+void TextureAtlas::reserve(SDL_Renderer* renderer, size_t pixels) {
+    size_t freePixels = 0;
+    for (const Page& page : pages) {
+        if (page.renderer == renderer) {
+            freePixels += (size_t)page.size * page.size - page.usedPixels;
+        }
+    }
+    if (pixels == 0 || freePixels >= pixels) return;
+    // skyline 装不满一页，按需要的面积多留一半
+    std::string error;
+    if (!createPage(renderer, pageSizeFor(pixels + pixels / 2), error)) {
+        LOG_WARN(CAT_PERF, "TextureAtlas: failed to create page: " << error);
+    }
+}
+
+bool TextureAtlas::find(SDL_Renderer* renderer, const std::string& path, const TextureLod& lod,
+                        TextureRegion& region) {
+    auto it = byKey.find({renderer, TextureCache::cacheKey(path, lod)});
+    if (it != byKey.end()) {
+        region = it->second;
+        TextureCache::retain(region.texture);
+        return true;
+    }
+    // 放不下图集的大图在 TextureCache 里
+    if (SDL_Texture* texture = TextureCache::find(renderer, path, lod)) {
+        region.texture = texture;
+        region.src = {0, 0, 0, 0};
+        SDL_QueryTexture(texture, nullptr, nullptr, &region.src.w, &region.src.h);
+        return true;
+    }
+    return false;
+}
+
+bool TextureAtlas::insert(SDL_Renderer* renderer, const std::string& path, const TextureLod& lod,
+                          const TextureContent& content, SDL_Surface* surface, TextureRegion& region,
+                          std::string& error) {
+    const std::string key = TextureCache::cacheKey(path, lod);
+    auto keyIt = byKey.find({renderer, key});
+    if (keyIt != byKey.end()) {
+        region = keyIt->second;
+        TextureCache::retain(region.texture);
+        return true;
+    }
+    auto hashIt = byHash.find({renderer, content.hash});
+    if (hashIt != byHash.end()) {
+        const HashedRegion& existing = hashIt->second;
+        if (existing.sourceBytes == content.sourceBytes && existing.region.src.w == surface->w &&
+            existing.region.src.h == surface->h && existing.format == surface->format->format) {
+            region = existing.region;
+            byKey[{renderer, key}] = region;
+            TextureCache::retain(region.texture);
+            return true;
+        }
+        // 哈希碰撞：按未命中处理，另外打包一份
+        LOG_WARN(CAT_PERF, "TextureAtlas: " << key << " has the same content hash as another image"
+                           << " but a different size or format, packing it separately");
+    }
+
+    if (!fits(surface->w, surface->h)) {
+        region.texture = TextureCache::insert(renderer, path, lod, content, surface, error);
+        region.src = {0, 0, surface->w, surface->h};
+        return region.texture != nullptr;
+    }
+
+    // 依次试已有的页，都放不下再开新页；右边和下边各留 PADDING
+    const int cellW = surface->w + PADDING;
+    const int cellH = surface->h + PADDING;
+    Page* page = nullptr;
+    SDL_Point position = {0, 0};
+    for (Page& candidate : pages) {
+        if (candidate.renderer == renderer && packInto(candidate, cellW, cellH, position)) {
+            page = &candidate;
+            break;
+        }
+    }
+    if (!page) {
+        // 已有的页都满了：新页不小于其中最大的一页，连续的单张插入不会开出一串小页
+        int size = pageSizeFor((size_t)cellW * cellH * 2, std::max(cellW, cellH));
+        for (const Page& existing : pages) {
+            if (existing.renderer == renderer) size = std::max(size, existing.size);
+        }
+        page = createPage(renderer, size, error);
+        if (!page) return false;
+        packInto(*page, cellW, cellH, position);
+    }
+
+    SDL_Surface* rgba = surface->format->format == SDL_PIXELFORMAT_RGBA32
+                            ? surface
+                            : SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+    if (!rgba) {
+        error = SDL_GetError();
+        return false;
+    }
+    const SDL_Rect src = {position.x, position.y, surface->w, surface->h};
+    const int result = SDL_UpdateTexture(page->texture, &src, rgba->pixels, rgba->pitch);
+    if (rgba != surface) SDL_FreeSurface(rgba);
+    if (result != 0) {
+        error = SDL_GetError();
+        return false;
+    }
+
+    region.texture = page->texture;
+    region.src = src;
+    byKey[{renderer, key}] = region;
+    if (content.hash != 0) {
+        HashedRegion hashed;
+        hashed.region = region;
+        hashed.sourceBytes = content.sourceBytes;
+        hashed.format = surface->format->format;
+        byHash.emplace(std::make_pair(renderer, content.hash), hashed);  // 哈希碰撞时保留先打包的
+    }
+    TextureCache::retain(region.texture);
+    LOG_DEBUG(CAT_PERF, "TextureAtlas: " << key << " -> page " << (page - pages.data()) << " (" << src.x << ", "
+                        << src.y << ", " << src.w << "x" << src.h << ")");
+    return true;
+}
+
+bool TextureAtlas::acquire(SDL_Renderer* renderer, const std::string& path, TextureRegion& region,
+                           const TextureLod& lod) {
+    if (find(renderer, path, lod, region)) {
+        return true;
+    }
+    TextureContent content;
+    std::string error;
+    SDL_Surface* surface = TextureCache::decodeFile(path, lod, content, error);
+    if (!surface) {
+        IMG_SetError("%s", error.c_str());
+        return false;
+    }
+    const bool ok = insert(renderer, path, lod, content, surface, region, error);
+    SDL_FreeSurface(surface);
+    if (!ok) {
+        IMG_SetError("%s", error.c_str());
+    }
+    return ok;
+}
+
+void TextureAtlas::releaseRenderer(SDL_Renderer* renderer) {
+    for (auto it = pages.begin(); it != pages.end();) {
+        if (it->renderer == renderer) {
+            TextureCache::release(it->texture);
+            it = pages.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = byKey.begin(); it != byKey.end();) {
+        it = it->first.first == renderer ? byKey.erase(it) : std::next(it);
+    }
+    for (auto it = byHash.begin(); it != byHash.end();) {
+        it = it->first.first == renderer ? byHash.erase(it) : std::next(it);
+    }
+}
+
+TextureAtlas::Stats TextureAtlas::getStats() {
+    Stats stats;
+    stats.pages = (int)pages.size();
+    stats.regions = (int)byHash.size();
+    for (const Page& page : pages) {
+        stats.pageBytes += (size_t)page.size * page.size * 4;
+        stats.usedPixels += page.usedPixels;
+    }
+    return stats;
+}
+
+void TextureAtlas::logReport() {
+    const Stats stats = getStats();
+    if (stats.pages == 0) return;
+    const double fill = 100.0 * stats.usedPixels * 4 / stats.pageBytes;
+    LOG_INFO(CAT_PERF, "TextureAtlas: " << stats.regions << " images on " << stats.pages << " pages ("
+                       << stats.pageBytes / 1024 << " KB), " << (int)fill << "% used");
+}
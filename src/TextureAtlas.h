@@ -0,0 +1,52 @@
+#pragma once
+#include "TextureCache.h"
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <string>
+
+// 纹理中的一块区域：图集里的小图，或者整张单独纹理
+struct TextureRegion {
+    SDL_Texture* texture = nullptr;
+    SDL_Rect src = {0, 0, 0, 0};
+};
+
+// 运行时图集：items 瓦片、金币、玩家等小图在加载时用 skyline 算法打包到少数几张图集页上，
+// 绘制时同一页的图片不用切换纹理，渲染器也能把连续的绘制合成一批。
+// 同一张图（按 TextureCache::cacheKey 或内容哈希）只打包一次；超过 MAX_PACKED_SIZE 的图（瓦片集、背景）仍是单独纹理。
+// 返回的 region.texture 是图集页（或单独纹理）的一个 TextureCache 引用，用完 TextureCache::release。
+// 图集页自己也持有一个引用，不会被 LRU 淘汰，直到 releaseRenderer。只能在渲染线程使用。
+class TextureAtlas {
+public:
+    static const int MIN_PAGE_SIZE = 128;
+    static const int PAGE_SIZE = 1024;       // 最大页尺寸，GLES2 设备普遍支持
+    static const int MAX_PACKED_SIZE = 256;  // 宽高都不超过它的图片才打包
+    static const int PADDING = 1;            // 图片之间留 1 像素透明间隔，最近邻采样不会串色
+
+    struct Stats {
+        int pages = 0;
+        int regions = 0;
+        size_t pageBytes = 0;
+        size_t usedPixels = 0;  // 已打包图片的像素数（含间隔）
+    };
+
+    static bool fits(int w, int h);  // 是否打包进图集
+
+    // 接下来要打包约 pixels 个像素（含间隔）：现有页的空闲面积不够时，按这个量开一张足够大的新页，
+    // 避免一批小图分散到多张按单张图大小开的页上
+    static void reserve(SDL_Renderer* renderer, size_t pixels);
+
+    // 已打包过的图片，命中时 region 的纹理引用 +1
+    static bool find(SDL_Renderer* renderer, const std::string& path, const TextureLod& lod, TextureRegion& region);
+    // 打包在别处解码好的图片（surface 由调用方释放）；大于 MAX_PACKED_SIZE 的图片退回 TextureCache 单独纹理。
+    // 失败返回 false 并填写 error
+    static bool insert(SDL_Renderer* renderer, const std::string& path, const TextureLod& lod,
+                       const TextureContent& content, SDL_Surface* surface, TextureRegion& region, std::string& error);
+    // 同步读取、解码并打包；失败返回 false，原因见 IMG_GetError
+    static bool acquire(SDL_Renderer* renderer, const std::string& path, TextureRegion& region,
+                        const TextureLod& lod = TextureLod());
+
+    // 释放该渲染器的图集页，必须在 TextureCache::releaseRenderer 之前调用
+    static void releaseRenderer(SDL_Renderer* renderer);
+    static Stats getStats();
+    static void logReport();
+};
@@ -0,0 +1,461 @@
+#include "TextureCache.h"
+#include "Log.h"
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct Entry {
+    SDL_Renderer* renderer = nullptr;
+    std::string path;        // 第一次登记时的键（报告用）
+    TextureContent content;  // hash 为 0 表示不参与内容去重（纯色占位等）
+    int sourceW = 0;         // 上传的 surface 的尺寸和像素格式，内容哈希命中时核对
+    int sourceH = 0;
+    Uint32 sourceFormat = 0;
+    size_t bytes = 0;
+    int refs = 0;
+    uint64_t lastUsed = 0;
+};
+
+const size_t DEFAULT_BUDGET = (size_t)256 << 20;
+
+std::unordered_map<SDL_Texture*, Entry> entries;
+std::map<std::pair<SDL_Renderer*, std::string>, SDL_Texture*> byPath;  // 多个路径可以指向同一纹理
+std::map<std::pair<SDL_Renderer*, uint64_t>, SDL_Texture*> byHash;
+TextureCache::Stats stats;
+size_t budget = DEFAULT_BUDGET;
+uint64_t useClock = 0;
+bool overBudgetWarned = false;
+
+size_t textureBytes(SDL_Texture* texture) {
+    Uint32 format = 0;
+    int w = 0, h = 0;
+    SDL_QueryTexture(texture, &format, nullptr, &w, &h);
+    int bytesPerPixel = SDL_BYTESPERPIXEL(format);
+    if (bytesPerPixel == 0) bytesPerPixel = 4;
+    return (size_t)w * h * bytesPerPixel;
+}
+
+SDL_Texture* addRef(SDL_Texture* texture) {
+    Entry& entry = entries[texture];
+    ++entry.refs;
+    entry.lastUsed = ++useClock;
+    return texture;
+}
+
+// source 为 nullptr 的纹理（图集页、纯色占位）不参与内容去重
+void registerTexture(SDL_Renderer* renderer, const std::string& key, const TextureContent& content,
+                     const SDL_Surface* source, SDL_Texture* texture) {
+    Entry entry;
+    entry.renderer = renderer;
+    entry.path = key;
+    if (source) {
+        entry.content = content;
+        entry.sourceW = source->w;
+        entry.sourceH = source->h;
+        entry.sourceFormat = source->format->format;
+    }
+    entry.bytes = textureBytes(texture);
+    entries[texture] = entry;
+    byPath[{renderer, key}] = texture;
+    if (entry.content.hash != 0) {
+        byHash.emplace(std::make_pair(renderer, entry.content.hash), texture);  // 哈希碰撞时保留先登记的
+    }
+    stats.residentBytes += entry.bytes;
+    ++stats.textures;
+    ++stats.loads;
+}
+
+void destroyEntry(SDL_Texture* texture) {
+    auto it = entries.find(texture);
+    if (it == entries.end()) return;
+    for (auto pathIt = byPath.begin(); pathIt != byPath.end();) {
+        pathIt = pathIt->second == texture ? byPath.erase(pathIt) : std::next(pathIt);
+    }
+    auto hashIt = byHash.find({it->second.renderer, it->second.content.hash});
+    if (hashIt != byHash.end() && hashIt->second == texture) {
+        byHash.erase(hashIt);
+    }
+    stats.residentBytes -= it->second.bytes;
+    --stats.textures;
+    entries.erase(it);
+    SDL_DestroyTexture(texture);
+}
+
+// 淘汰没有引用、最久没用的纹理，直到回到预算以内
+void evictOverBudget() {
+    while (stats.residentBytes > budget) {
+        SDL_Texture* oldest = nullptr;
+        uint64_t oldestUse = UINT64_MAX;
+        for (const auto& [texture, entry] : entries) {
+            if (entry.refs == 0 && entry.lastUsed < oldestUse) {
+                oldest = texture;
+                oldestUse = entry.lastUsed;
+            }
+        }
+        if (!oldest) {
+            if (!overBudgetWarned) {
+                LOG_WARN(CAT_PERF, "TextureCache: " << (stats.residentBytes >> 20) << " MB in use exceeds budget "
+                                   << (budget >> 20) << " MB, nothing left to evict");
+                overBudgetWarned = true;
+            }
+            return;
+        }
+        LOG_DEBUG(CAT_PERF, "TextureCache: evict " << entries[oldest].path);
+        destroyEntry(oldest);
+        ++stats.evictions;
+    }
+    overBudgetWarned = false;
+}
+
+// 用 SDL_RWFromFile 打开：它在 Windows 上把路径当 UTF-8 处理，fopen 走 ANSI 代码页，非 ASCII 路径会打不开
+bool readFile(const std::string& path, std::vector<uint8_t>& data) {
+    SDL_RWops* file = SDL_RWFromFile(path.c_str(), "rb");
+    if (!file) return false;
+    const Sint64 size = SDL_RWsize(file);
+    bool ok = size >= 0;
+    if (ok) {
+        data.resize((size_t)size);
+        ok = size == 0 || SDL_RWread(file, data.data(), 1, (size_t)size) == (size_t)size;
+    }
+    SDL_RWclose(file);
+    return ok;
+}
+
+// 一维面积平均的权重：目标像素 i 覆盖源区间 [i * ratio, (i + 1) * ratio)，每个源像素按重叠长度加权
+struct Span {
+    int first = 0;
+    int count = 0;
+    size_t weights = 0;  // 在权重数组里的起点
+};
+
+void buildSpans(int srcSize, int dstSize, std::vector<Span>& spans, std::vector<float>& weights) {
+    const double ratio = (double)srcSize / dstSize;
+    spans.resize(dstSize);
+    for (int i = 0; i < dstSize; ++i) {
+        const double begin = i * ratio;
+        const double end = std::min((double)srcSize, (i + 1) * ratio);
+        Span& span = spans[i];
+        span.first = (int)begin;
+        span.count = std::max(1, (int)std::ceil(end) - span.first);
+        span.weights = weights.size();
+        for (int s = 0; s < span.count; ++s) {
+            const double overlap = std::min(end, span.first + s + 1.0) - std::max(begin, (double)(span.first + s));
+            weights.push_back((float)(std::max(0.0, overlap) / ratio));
+        }
+    }
+}
+
+}  // namespace
+
+void TextureLod::targetSize(int srcW, int srcH, int& w, int& h) const {
+    w = srcW;
+    h = srcH;
+    if (width <= 0 || height <= 0) return;
+    if (mode == LOD_FIT) {
+        const double scale = std::min((double)width / srcW, (double)height / srcH);
+        if (scale < 1.0) {
+            w = std::max(1, (int)std::lround(srcW * scale));
+            h = std::max(1, (int)std::lround(srcH * scale));
+        }
+    } else if (mode == LOD_STRETCH) {
+        w = std::min(srcW, width);
+        h = std::min(srcH, height);
+    }
+}
+
+SDL_Surface* TextureCache::downscale(SDL_Surface* source, int w, int h) {
+    // 带 alpha 的 PNG 解码出来通常已经是 RGBA32，不用再复制一份
+    SDL_Surface* rgba = source->format->format == SDL_PIXELFORMAT_RGBA32
+                            ? source
+                            : SDL_ConvertSurfaceFormat(source, SDL_PIXELFORMAT_RGBA32, 0);
+    if (!rgba) return nullptr;
+    SDL_Surface* result = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!result) {
+        if (rgba != source) SDL_FreeSurface(rgba);
+        return nullptr;
+    }
+
+    std::vector<Span> columns, rows;
+    std::vector<float> columnWeights, rowWeights;
+    buildSpans(rgba->w, w, columns, columnWeights);
+    buildSpans(rgba->h, h, rows, rowWeights);
+
+    // 先横向缩到 w x 源高度（预乘 alpha 的浮点），再纵向缩到 w x h
+    std::vector<float> horizontal((size_t)w * rgba->h * 4);
+    for (int y = 0; y < rgba->h; ++y) {
+        const uint8_t* srcRow = static_cast<const uint8_t*>(rgba->pixels) + (size_t)y * rgba->pitch;
+        float* out = &horizontal[(size_t)y * w * 4];
+        for (int x = 0; x < w; ++x, out += 4) {
+            const Span& span = columns[x];
+            float r = 0, g = 0, b = 0, a = 0;
+            for (int s = 0; s < span.count; ++s) {
+                const uint8_t* pixel = srcRow + (size_t)(span.first + s) * 4;
+                const float alpha = pixel[3] * columnWeights[span.weights + s];
+                r += pixel[0] * alpha;
+                g += pixel[1] * alpha;
+                b += pixel[2] * alpha;
+                a += alpha;
+            }
+            out[0] = r;
+            out[1] = g;
+            out[2] = b;
+            out[3] = a;
+        }
+    }
+    std::vector<float> sum((size_t)w * 4);
+    for (int y = 0; y < h; ++y) {
+        const Span& span = rows[y];
+        std::fill(sum.begin(), sum.end(), 0.0f);
+        for (int s = 0; s < span.count; ++s) {
+            const float* in = &horizontal[(size_t)(span.first + s) * w * 4];
+            const float weight = rowWeights[span.weights + s];
+            for (size_t i = 0; i < sum.size(); ++i) sum[i] += in[i] * weight;
+        }
+        uint8_t* pixel = static_cast<uint8_t*>(result->pixels) + (size_t)y * result->pitch;
+        for (int x = 0; x < w; ++x, pixel += 4) {
+            const float* premultiplied = &sum[(size_t)x * 4];
+            const float alpha = premultiplied[3];
+            for (int c = 0; c < 3; ++c) {
+                pixel[c] = alpha > 0.0f ? (uint8_t)std::min(255.0f, premultiplied[c] / alpha + 0.5f) : 0;
+            }
+            pixel[3] = (uint8_t)std::min(255.0f, alpha + 0.5f);
+        }
+    }
+    if (rgba != source) SDL_FreeSurface(rgba);
+    return result;
+}
+
+SDL_Surface* TextureCache::decodeFile(const std::string& path, const Lod& lod, TextureContent& content,
+                                      std::string& error) {
+    std::vector<uint8_t> data;
+    if (!readFile(path, data)) {
+        error = "Couldn't open " + path;
+        return nullptr;
+    }
+    content.hash = hashContent(data.data(), data.size());
+    content.sourceBytes = data.size();
+    SDL_Surface* surface = IMG_Load_RW(SDL_RWFromConstMem(data.data(), (int)data.size()), 1);
+    if (!surface) {
+        error = IMG_GetError();
+        return nullptr;
+    }
+
+    int w, h;
+    lod.targetSize(surface->w, surface->h, w, h);
+    if (w == surface->w && h == surface->h) {
+        return surface;  // 不需要缩小，和原图共用同一个内容哈希
+    }
+    SDL_Surface* scaled = downscale(surface, w, h);
+    if (!scaled) {
+        error = SDL_GetError();
+        SDL_FreeSurface(surface);
+        return nullptr;
+    }
+    LOG_DEBUG(CAT_PERF, "TextureCache: LOD " << path << " " << surface->w << "x" << surface->h << " -> " << w << "x"
+                        << h);
+    SDL_FreeSurface(surface);
+    // 缩小后的内容由原文件和目标尺寸决定
+    const uint64_t key[3] = {content.hash, (uint64_t)w, (uint64_t)h};
+    content.hash = hashContent(key, sizeof(key));
+    return scaled;
+}
+
+SDL_Texture* TextureCache::find(SDL_Renderer* renderer, const std::string& path, const Lod& lod) {
+    auto it = byPath.find({renderer, cacheKey(path, lod)});
+    if (it == byPath.end()) return nullptr;
+    ++stats.hits;
+    return addRef(it->second);
+}
+
+SDL_Texture* TextureCache::acquire(SDL_Renderer* renderer, const std::string& path, const Lod& lod) {
+    if (SDL_Texture* cached = find(renderer, path, lod)) {
+        return cached;
+    }
+    TextureContent content;
+    std::string error;
+    SDL_Surface* surface = decodeFile(path, lod, content, error);
+    if (!surface) {
+        IMG_SetError("%s", error.c_str());
+        return nullptr;
+    }
+    SDL_Texture* texture = insert(renderer, path, lod, content, surface, error);
+    SDL_FreeSurface(surface);
+    if (!texture) {
+        IMG_SetError("%s", error.c_str());
+    }
+    return texture;
+}
+
+SDL_Texture* TextureCache::insert(SDL_Renderer* renderer, const std::string& path, const Lod& lod,
+                                  const TextureContent& content, SDL_Surface* surface, std::string& error) {
+    const std::string key = cacheKey(path, lod);
+    auto pathIt = byPath.find({renderer, key});
+    if (pathIt != byPath.end()) {
+        ++stats.hits;
+        return addRef(pathIt->second);
+    }
+    auto hashIt = byHash.find({renderer, content.hash});
+    if (hashIt != byHash.end()) {
+        const Entry& existing = entries[hashIt->second];
+        if (existing.content.sourceBytes == content.sourceBytes && existing.sourceW == surface->w &&
+            existing.sourceH == surface->h && existing.sourceFormat == surface->format->format) {
+            // 内容相同的另一份文件：新路径也指向已有纹理
+            LOG_DEBUG(CAT_PERF, "TextureCache: " << key << " is identical to " << existing.path);
+            byPath[{renderer, key}] = hashIt->second;
+            ++stats.contentHits;
+            return addRef(hashIt->second);
+        }
+        // 哈希碰撞：按未命中处理，单独上传
+        LOG_WARN(CAT_PERF, "TextureCache: " << key << " has the same content hash as " << existing.path
+                           << " but a different size or format, loading it separately");
+    }
+
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    if (!texture) {
+        error = SDL_GetError();
+        return nullptr;
+    }
+    registerTexture(renderer, key, content, surface, texture);
+    addRef(texture);
+    evictOverBudget();
+    return texture;
+}
+
+SDL_Texture* TextureCache::acquireSolid(SDL_Renderer* renderer, int w, int h, Uint8 r, Uint8 g, Uint8 b) {
+    char key[64];
+    std::snprintf(key, sizeof(key), "@solid/%dx%d/%02x%02x%02x", w, h, r, g, b);
+    auto it = byPath.find({renderer, key});
+    if (it != byPath.end()) {
+        ++stats.hits;
+        return addRef(it->second);
+    }
+    SDL_Surface* surface = SDL_CreateRGBSurface(0, w, h, 32, 0, 0, 0, 0);
+    if (!surface) return nullptr;
+    SDL_FillRect(surface, nullptr, SDL_MapRGB(surface->format, r, g, b));
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_FreeSurface(surface);
+    if (!texture) return nullptr;
+    registerTexture(renderer, key, TextureContent(), nullptr, texture);
+    addRef(texture);
+    evictOverBudget();
+    return texture;
+}
+
+SDL_Texture* TextureCache::adopt(SDL_Renderer* renderer, const std::string& key, SDL_Texture* texture) {
+    registerTexture(renderer, key, TextureContent(), nullptr, texture);
+    addRef(texture);
+    evictOverBudget();
+    return texture;
+}
+
+SDL_Texture* TextureCache::retain(SDL_Texture* texture) {
+    return texture && entries.count(texture) ? addRef(texture) : texture;
+}
+
+void TextureCache::release(SDL_Texture* texture) {
+    if (!texture) return;
+    auto it = entries.find(texture);
+    if (it == entries.end()) {
+        SDL_DestroyTexture(texture);
+        return;
+    }
+    if (it->second.refs > 0 && --it->second.refs == 0) {
+        it->second.lastUsed = ++useClock;
+        evictOverBudget();
+    }
+}
+
+void TextureCache::releaseRenderer(SDL_Renderer* renderer) {
+    std::vector<SDL_Texture*> owned;
+    int referenced = 0;
+    for (const auto& [texture, entry] : entries) {
+        if (entry.renderer == renderer) {
+            owned.push_back(texture);
+            if (entry.refs > 0) ++referenced;
+        }
+    }
+    if (referenced > 0) {
+        LOG_WARN(CAT_PERF, "TextureCache: destroying " << referenced << " textures that are still referenced");
+    }
+    for (SDL_Texture* texture : owned) {
+        destroyEntry(texture);
+    }
+}
+
+void TextureCache::setBudget(size_t bytes) {
+    budget = bytes;
+    evictOverBudget();
+}
+
+size_t TextureCache::getBudget() {
+    return budget;
+}
+
+TextureCache::Stats TextureCache::getStats() {
+    Stats result = stats;
+    result.referenced = 0;
+    for (const auto& [texture, entry] : entries) {
+        if (entry.refs > 0) ++result.referenced;
+    }
+    return result;
+}
+
+void TextureCache::logReport() {
+    std::vector<const Entry*> sorted;
+    for (const auto& [texture, entry] : entries) {
+        sorted.push_back(&entry);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Entry* a, const Entry* b) { return a->bytes > b->bytes; });
+
+    const Stats current = getStats();
+    LOG_INFO(CAT_PERF, "TextureCache: " << current.textures << " textures, " << current.residentBytes / 1024
+                       << " KB resident (budget " << (budget >> 20) << " MB), " << current.referenced
+                       << " in use; hits " << current.hits << ", identical content " << current.contentHits
+                       << ", loads " << current.loads << ", evictions " << current.evictions);
+    for (const Entry* entry : sorted) {
+        LOG_INFO(CAT_PERF, "  " << entry->bytes / 1024 << " KB  refs " << entry->refs << "  " << entry->path);
+    }
+}
+
+// FNV-1a，混入长度
+uint64_t TextureCache::hashContent(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    hash ^= (uint64_t)size * 0x9E3779B97F4A7C15ull;
+    return hash != 0 ? hash : 1;
+}
+
+std::string TextureCache::cacheKey(const std::string& path, const Lod& lod) {
+    std::string key = canonicalPath(path);
+    if (lod.mode != TextureLod::LOD_NONE) {
+        char suffix[48];
+        std::snprintf(suffix, sizeof(suffix), "#%s%dx%d", lod.mode == TextureLod::LOD_FIT ? "fit" : "stretch",
+                      lod.width, lod.height);
+        key += suffix;
+    }
+    return key;
+}
+
+std::string TextureCache::canonicalPath(const std::string& path) {
+    std::error_code ec;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(std::filesystem::u8path(path), ec);
+    std::string result = ec ? path : canonical.generic_u8string();
+#ifdef _WIN32
+    // Windows 路径不区分大小写
+    std::transform(result.begin(), result.end(), result.begin(),
+                   [](unsigned char c) { return (char)std::tolower(c); });
+#endif
+    return result;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 加载时降采样（LOD）：图片按最大绘制尺寸缩小，只缩小不放大；绘制尺寸应已乘上 renderScale 和窗口输出缩放
+struct TextureLod {
+    enum Mode {
+        LOD_NONE,     // 原样加载
+        LOD_FIT,      // 等比缩放后完整放进 width x height 绘制（如死亡/通关画面）
+        LOD_STRETCH   // 拉伸到 width x height 绘制（如菜单背景、玩家精灵），两个方向分别缩放
+    };
+    Mode mode = LOD_NONE;
+    int width = 0;
+    int height = 0;
+
+    static TextureLod fit(int w, int h) { return {LOD_FIT, w, h}; }
+    static TextureLod stretch(int w, int h) { return {LOD_STRETCH, w, h}; }
+    // 源图 srcW x srcH 降采样后的尺寸，不需要缩小时返回原尺寸
+    void targetSize(int srcW, int srcH, int& w, int& h) const;
+};
+
+// 解码得到的图片内容标识：64 位哈希可能碰撞，复用已有纹理前还要核对源文件字节数和 surface 的尺寸、格式
+struct TextureContent {
+    uint64_t hash = 0;       // 0 表示不参与内容去重
+    size_t sourceBytes = 0;  // 源文件字节数
+};
+
+// 全局纹理缓存：同一渲染器上的纹理按规范化路径去重，路径不同但文件内容相同（哈希一致）的也共用一份。
+// 引用计数：acquire/insert 得到的纹理用完后 release，不要 SDL_DestroyTexture。
+// 没有引用的纹理留在缓存里供下次直接使用，常驻字节数超出预算时按最近使用时间（LRU）淘汰。
+// 图片可以在加载时按最大绘制尺寸降采样（LOD），同一文件的不同 LOD 是不同的缓存项，只有真的用到时才会同时存在。
+// 只能在渲染线程使用。
+class TextureCache {
+public:
+    using Lod = TextureLod;
+
+    struct Stats {
+        size_t residentBytes = 0;  // 按宽 x 高 x 每像素字节数估算的显存占用
+        int textures = 0;
+        int referenced = 0;        // 仍有引用的纹理数
+        size_t hits = 0;           // 路径命中
+        size_t contentHits = 0;    // 路径不同、内容相同的命中
+        size_t loads = 0;
+        size_t evictions = 0;
+    };
+
+    // 取得 path 的纹理（引用 +1），不在缓存里时同步读取并解码；失败返回 nullptr，原因见 IMG_GetError
+    static SDL_Texture* acquire(SDL_Renderer* renderer, const std::string& path, const Lod& lod = Lod());
+    // 只查缓存，命中时引用 +1，不加载
+    static SDL_Texture* find(SDL_Renderer* renderer, const std::string& path, const Lod& lod = Lod());
+    // 登记在别处解码好的图片（ImageLoader 在工作线程解码，surface 已按 lod 降采样）：
+    // 内容相同（哈希、源文件字节数、surface 尺寸和格式都一致）的纹理直接复用，否则上传 surface。
+    // surface 总是由调用方释放；失败返回 nullptr 并填写 error
+    static SDL_Texture* insert(SDL_Renderer* renderer, const std::string& path, const Lod& lod,
+                               const TextureContent& content, SDL_Surface* surface, std::string& error);
+    // 登记在别处创建的纹理（TextureAtlas 的图集页），调用方持有返回的这一个引用
+    static SDL_Texture* adopt(SDL_Renderer* renderer, const std::string& key, SDL_Texture* texture);
+    static SDL_Texture* retain(SDL_Texture* texture);  // 引用 +1，返回 texture
+    // 纯色占位纹理（图片加载失败时用），同尺寸同颜色的共用一份
+    static SDL_Texture* acquireSolid(SDL_Renderer* renderer, int w, int h, Uint8 r, Uint8 g, Uint8 b);
+    // 引用 -1，nullptr 忽略；不是缓存里的纹理直接销毁
+    static void release(SDL_Texture* texture);
+    // 销毁该渲染器的所有纹理（渲染器销毁之前调用）
+    static void releaseRenderer(SDL_Renderer* renderer);
+
+    static void setBudget(size_t bytes);
+    static size_t getBudget();
+    static Stats getStats();
+    static void logReport();  // 每个常驻纹理的大小、引用数和路径
+
+    // 读文件、算内容标识、解码成 surface 并按 lod 降采样，不碰缓存，可以在工作线程调用
+    static SDL_Surface* decodeFile(const std::string& path, const Lod& lod, TextureContent& content,
+                                   std::string& error);
+    // 面积平均（box filter）缩小，按预乘 alpha 混合避免透明边缘发黑；返回新的 RGBA32 surface，失败返回 nullptr
+    static SDL_Surface* downscale(SDL_Surface* source, int w, int h);
+    static uint64_t hashContent(const void* data, size_t size);
+    static std::string canonicalPath(const std::string& path);
+    // 缓存键：规范化路径，降采样的再带上 LOD，不同绘制尺寸的 LOD 分开缓存
+    static std::string cacheKey(const std::string& path, const Lod& lod);
+};
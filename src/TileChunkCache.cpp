@@ -0,0 +1,197 @@
+#include "TileChunkCache.h"
+#include "Log.h"
+#include "RenderStats.h"
+#include <algorithm>
+#include <cmath>
+
+TileChunkCache::~TileChunkCache() {
+    releaseAll();
+}
+
+void TileChunkCache::init(int mapPixelW, int mapPixelH, int chunkPixelW, int chunkPixelH) {
+    releaseAll();
+    unavailable = false;
+    chunkW = std::max(1, chunkPixelW);
+    chunkH = std::max(1, chunkPixelH);
+    chunksX = (mapPixelW + chunkW - 1) / chunkW;
+    chunksY = (mapPixelH + chunkH - 1) / chunkH;
+    chunks.assign((size_t)chunksX * chunksY, Chunk{});
+    LOG_INFO(CAT_MAP, "Tile chunk cache: " << chunksX << "x" << chunksY << " chunks of "
+                      << chunkW << "x" << chunkH << " px, budget " << maxResident << " chunks");
+}
+
+bool TileChunkCache::render(SDL_Renderer* renderer, const SDL_Rect& view, float renderScale,
+                            const BakeFn& bake) {
+    if (unavailable || chunks.empty() || renderScale <= 0.0f) {
+        return false;
+    }
+    if (!SDL_RenderTargetSupported(renderer)) {
+        LOG_WARN(CAT_MAP, "Renderer has no render target support, tile chunk cache disabled");
+        unavailable = true;
+        return false;
+    }
+    ++frameCounter;
+
+    // 视野换算回未缩放的世界坐标，求出覆盖的块范围
+    int worldX0 = (int)std::floor(view.x / renderScale);
+    int worldY0 = (int)std::floor(view.y / renderScale);
+    int worldX1 = (int)std::ceil((view.x + view.w) / renderScale);
+    int worldY1 = (int)std::ceil((view.y + view.h) / renderScale);
+    int startCX = std::max(0, worldX0 / chunkW);
+    int startCY = std::max(0, worldY0 / chunkH);
+    int endCX = std::min(chunksX, (worldX1 + chunkW - 1) / chunkW);
+    int endCY = std::min(chunksY, (worldY1 + chunkH - 1) / chunkH);
+
+    // 可见块不会被淘汰：视野（放大后的窗口或缩小的 renderScale）加一圈余量超过预算时把预算提上去，
+    // 否则缓存会一直超预算，刚离开视野的块每帧都被淘汰、回来时又要重新烘焙
+    const int neededResident = std::min(std::max(0, endCX - startCX) + 2, chunksX) *
+                               std::min(std::max(0, endCY - startCY) + 2, chunksY);
+    if (neededResident > maxResident) {
+        LOG_WARN(CAT_MAP, "Tile chunk cache: view covers " << (endCX - startCX) << "x" << (endCY - startCY)
+                          << " chunks, raising budget from " << maxResident << " to " << neededResident << " chunks");
+        maxResident = neededResident;
+    }
+
+    // 先保证所有可见块都已烘焙，任何一个失败就整帧退回逐瓦片渲染，避免重复绘制
+    for (int cy = startCY; cy < endCY; ++cy) {
+        for (int cx = startCX; cx < endCX; ++cx) {
+            Chunk& chunk = chunks[(size_t)cy * chunksX + cx];
+            if (!chunk.texture) {
+                chunk.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                                                  SDL_TEXTUREACCESS_TARGET, chunkW, chunkH);
+                if (!chunk.texture) {
+                    LOG_WARN(CAT_MAP, "Tile chunk texture creation failed, falling back to per-tile rendering: "
+                                      << SDL_GetError());
+                    unavailable = true;
+                    releaseAll();
+                    return false;
+                }
+                ++residentCount;
+                chunk.dirty = true;
+            }
+            if (chunk.dirty) {
+                bakeChunk(renderer, chunk, cx, cy, bake);
+            }
+            chunk.lastUsedFrame = frameCounter;
+        }
+    }
+
+    for (int cy = startCY; cy < endCY; ++cy) {
+        for (int cx = startCX; cx < endCX; ++cx) {
+            const Chunk& chunk = chunks[(size_t)cy * chunksX + cx];
+            // 用相邻块边界各自取整，避免缩放时块之间出现缝隙
+            int x0 = (int)(cx * chunkW * renderScale);
+            int y0 = (int)(cy * chunkH * renderScale);
+            int x1 = (int)((cx + 1) * chunkW * renderScale);
+            int y1 = (int)((cy + 1) * chunkH * renderScale);
+            SDL_Rect dest = {x0 - view.x, y0 - view.y, x1 - x0, y1 - y0};
+            RenderStats::copy(renderer, chunk.texture, nullptr, &dest);
+        }
+    }
+
+    evictOverBudget(view, renderScale);
+    return true;
+}
+
+void TileChunkCache::bakeChunk(SDL_Renderer* renderer, Chunk& chunk, int cx, int cy, const BakeFn& bake) {
+    // 块纹理里存的是预乘 alpha 的结果，绘制时需要 (ONE, ONE_MINUS_SRC_ALPHA) 混合
+    if (!blendModeResolved) {
+        SDL_BlendMode premultiplied = SDL_ComposeCustomBlendMode(
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+        chunkBlendMode = SDL_SetTextureBlendMode(chunk.texture, premultiplied) == 0
+                             ? premultiplied
+                             : SDL_BLENDMODE_BLEND;
+        blendModeResolved = true;
+    }
+    SDL_SetTextureBlendMode(chunk.texture, chunkBlendMode);
+
+    SDL_Texture* prevTarget = SDL_GetRenderTarget(renderer);
+    Uint8 r, g, b, a;
+    SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+    SDL_BlendMode prevBlend;
+    SDL_GetRenderDrawBlendMode(renderer, &prevBlend);
+
+    SDL_SetRenderTarget(renderer, chunk.texture);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+
+    SDL_Rect worldRect = {cx * chunkW, cy * chunkH, chunkW, chunkH};
+    bake(renderer, worldRect);
+
+    SDL_SetRenderTarget(renderer, prevTarget);
+    SDL_SetRenderDrawColor(renderer, r, g, b, a);
+    SDL_SetRenderDrawBlendMode(renderer, prevBlend);
+    chunk.dirty = false;
+}
+
+void TileChunkCache::evictOverBudget(const SDL_Rect& view, float renderScale) {
+    if (residentCount <= maxResident) {
+        return;
+    }
+
+    float centerX = (view.x + view.w / 2.0f) / renderScale;
+    float centerY = (view.y + view.h / 2.0f) / renderScale;
+
+    // 候选：本帧没有用到的常驻块；先淘汰最久未用的，同样久则淘汰离相机最远的
+    std::vector<std::pair<size_t, float>> candidates;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        const Chunk& chunk = chunks[i];
+        if (!chunk.texture || chunk.lastUsedFrame == frameCounter) {
+            continue;
+        }
+        float dx = (i % chunksX + 0.5f) * chunkW - centerX;
+        float dy = (i / chunksX + 0.5f) * chunkH - centerY;
+        candidates.emplace_back(i, dx * dx + dy * dy);
+    }
+    std::sort(candidates.begin(), candidates.end(), [this](const auto& a, const auto& b) {
+        Uint32 usedA = chunks[a.first].lastUsedFrame;
+        Uint32 usedB = chunks[b.first].lastUsedFrame;
+        if (usedA != usedB) return usedA < usedB;
+        return a.second > b.second;
+    });
+
+    for (const auto& [index, dist] : candidates) {
+        if (residentCount <= maxResident) {
+            break;
+        }
+        Chunk& chunk = chunks[index];
+        SDL_DestroyTexture(chunk.texture);
+        chunk.texture = nullptr;
+        chunk.dirty = true;
+        --residentCount;
+    }
+}
+
+void TileChunkCache::invalidate(const SDL_Rect& worldRect) {
+    if (chunks.empty() || worldRect.w <= 0 || worldRect.h <= 0) {
+        return;
+    }
+    int startCX = std::max(0, worldRect.x / chunkW);
+    int startCY = std::max(0, worldRect.y / chunkH);
+    int endCX = std::min(chunksX - 1, (worldRect.x + worldRect.w - 1) / chunkW);
+    int endCY = std::min(chunksY - 1, (worldRect.y + worldRect.h - 1) / chunkH);
+    for (int cy = startCY; cy <= endCY; ++cy) {
+        for (int cx = startCX; cx <= endCX; ++cx) {
+            chunks[(size_t)cy * chunksX + cx].dirty = true;
+        }
+    }
+}
+
+void TileChunkCache::invalidateAll() {
+    for (auto& chunk : chunks) {
+        chunk.dirty = true;
+    }
+}
+
+void TileChunkCache::releaseAll() {
+    for (auto& chunk : chunks) {
+        if (chunk.texture) {
+            SDL_DestroyTexture(chunk.texture);
+            chunk.texture = nullptr;
+        }
+        chunk.dirty = true;
+    }
+    residentCount = 0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <functional>
+#include <vector>
+
+// 静态瓦片层的分块渲染缓存：把地图按块烘焙到渲染目标纹理，每帧只绘制几个块。
+// 块在第一次可见时烘焙，被标脏后下次可见时重新烘焙，超出预算时按 LRU 淘汰离相机最远的块。
+// 预算至少是可见块外加一圈的数量，视野变大时自动提高（并打一条警告）。
+class TileChunkCache {
+public:
+    // 烘焙回调：把世界坐标（未缩放）worldRect 范围内的瓦片画到当前渲染目标的 (0,0) 处
+    using BakeFn = std::function<void(SDL_Renderer*, const SDL_Rect& worldRect)>;
+
+    TileChunkCache() = default;
+    ~TileChunkCache();
+    TileChunkCache(const TileChunkCache&) = delete;
+    TileChunkCache& operator=(const TileChunkCache&) = delete;
+
+    void init(int mapPixelW, int mapPixelH, int chunkPixelW, int chunkPixelH);
+    void setMaxResidentChunks(int count) { maxResident = count; }
+    int getMaxResidentChunks() const { return maxResident; }
+    int getResidentChunks() const { return residentCount; }
+    size_t getResidentBytes() const { return (size_t)residentCount * chunkW * chunkH * 4; }
+
+    // view 为缩放后的相机视野（与 Camera::getView 一致），返回 false 表示渲染器不支持渲染目标
+    bool render(SDL_Renderer* renderer, const SDL_Rect& view, float renderScale, const BakeFn& bake);
+    void invalidate(const SDL_Rect& worldRect);  // 标脏与 worldRect 相交的块
+    void invalidateAll();
+    void releaseAll();  // 释放所有块纹理（渲染目标丢失时也用这个）
+
+private:
+    struct Chunk {
+        SDL_Texture* texture = nullptr;
+        bool dirty = true;
+        Uint32 lastUsedFrame = 0;
+    };
+
+    void bakeChunk(SDL_Renderer* renderer, Chunk& chunk, int cx, int cy, const BakeFn& bake);
+    void evictOverBudget(const SDL_Rect& view, float renderScale);
+
+    std::vector<Chunk> chunks;
+    int chunksX = 0;
+    int chunksY = 0;
+    int chunkW = 512;
+    int chunkH = 512;
+    int maxResident = 24;
+    int residentCount = 0;
+    Uint32 frameCounter = 0;
+    SDL_BlendMode chunkBlendMode = SDL_BLENDMODE_BLEND;
+    bool blendModeResolved = false;
+    bool unavailable = false;  // 渲染器不支持渲染目标或创建失败后不再尝试
+};
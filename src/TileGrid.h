@@ -0,0 +1,162 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Tiled 图层数据中 GID 的高位是翻转标记，其余位才是真正的 GID
+namespace TiledGid {
+    const uint32_t FLIPPED_HORIZONTALLY = 0x80000000u;
+    const uint32_t FLIPPED_VERTICALLY = 0x40000000u;
+    const uint32_t FLIPPED_DIAGONALLY = 0x20000000u;
+    const uint32_t ROTATED_HEXAGONAL_120 = 0x10000000u;  // 仅六边形地图使用，正交地图忽略
+    const uint32_t GID_MASK = 0x0FFFFFFFu;
+}
+
+// 解码后的翻转标记（与 Tiled 原始位顺序一致：H=4, V=2, D=1）
+enum TileFlip : uint8_t {
+    TILE_FLIP_NONE = 0,
+    TILE_FLIP_DIAGONAL = 1,
+    TILE_FLIP_VERTICAL = 2,
+    TILE_FLIP_HORIZONTAL = 4
+};
+
+// 连续存储的瓦片网格（按行步长索引），替代 vector<vector<int>>。
+// 每个格子的最高 3 位存翻转标记，剩余位存 GID；Cell 为 uint16_t 时 GID 上限 8191。
+// 格子可以放在自己的 vector 里，也可以 attach 到外部内存（内存映射的编译地图）原地使用。
+template <typename Cell>
+class BasicTileGrid {
+public:
+    using CellType = Cell;
+    static constexpr int CELL_BITS = (int)sizeof(Cell) * 8;
+    static constexpr int FLIP_SHIFT = CELL_BITS - 3;
+    static constexpr Cell GID_BITS = (Cell)((Cell(1) << FLIP_SHIFT) - 1);
+    static constexpr uint32_t MAX_GID = GID_BITS;
+
+    BasicTileGrid() = default;
+    BasicTileGrid(int w, int h) { resize(w, h); }
+    BasicTileGrid(const BasicTileGrid& other)
+        : width(other.width), height(other.height), cells(other.cells), external(other.external) {
+        base = external ? other.base : cells.data();
+    }
+    BasicTileGrid(BasicTileGrid&& other) noexcept
+        : width(other.width), height(other.height), cells(std::move(other.cells)), external(other.external) {
+        base = external ? other.base : cells.data();
+        other.width = other.height = 0;
+        other.base = nullptr;
+        other.external = false;
+    }
+    BasicTileGrid& operator=(BasicTileGrid other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void swap(BasicTileGrid& other) noexcept {
+        std::swap(width, other.width);
+        std::swap(height, other.height);
+        cells.swap(other.cells);  // vector 交换缓冲区，base 跟着一起换仍然有效
+        std::swap(base, other.base);
+        std::swap(external, other.external);
+    }
+
+    void resize(int w, int h) {
+        width = w > 0 ? w : 0;
+        height = h > 0 ? h : 0;
+        cells.assign((size_t)width * height, 0);
+        base = cells.data();
+        external = false;
+    }
+
+    // 接管已经编码好的格子（按行存储），不足 w*h 的补 0，多出的丢弃
+    void adopt(int w, int h, std::vector<Cell>&& encoded) {
+        width = w > 0 ? w : 0;
+        height = h > 0 ? h : 0;
+        cells = std::move(encoded);
+        cells.resize((size_t)width * height, 0);
+        cells.shrink_to_fit();
+        base = cells.data();
+        external = false;
+    }
+
+    // 直接使用外部的 w*h 个格子，不复制；外部内存必须比网格活得久（写入会改到外部内存上）
+    void attach(int w, int h, Cell* externalCells) {
+        width = w > 0 ? w : 0;
+        height = h > 0 ? h : 0;
+        std::vector<Cell>().swap(cells);
+        base = externalCells;
+        external = true;
+    }
+    bool isAttached() const { return external; }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    bool empty() const { return cellCount() == 0; }
+    bool inBounds(int x, int y) const { return x >= 0 && y >= 0 && x < width && y < height; }
+
+    // 未检查边界的访问，调用方保证 inBounds
+    Cell raw(int x, int y) const { return base[(size_t)y * width + x]; }
+    int gid(int x, int y) const { return raw(x, y) & GID_BITS; }
+    uint8_t flip(int x, int y) const { return (uint8_t)(raw(x, y) >> FLIP_SHIFT); }
+    const Cell* row(int y) const { return base + (size_t)y * width; }
+    const Cell* data() const { return base; }
+    Cell* data() { return base; }
+    size_t cellCount() const { return (size_t)width * height; }
+
+    void clear(int x, int y) { base[(size_t)y * width + x] = 0; }
+    void setRaw(int x, int y, Cell cell) { base[(size_t)y * width + x] = cell; }
+
+    // 写入 Tiled 原始 GID（含翻转标记），GID 超出格子位宽时返回 false
+    bool setTiled(int x, int y, uint32_t tiledGid) {
+        Cell cell;
+        if (!encode(tiledGid, cell)) return false;
+        base[(size_t)y * width + x] = cell;
+        return true;
+    }
+
+    static int gidOf(Cell cell) { return cell & GID_BITS; }
+    static uint8_t flipOf(Cell cell) { return (uint8_t)(cell >> FLIP_SHIFT); }
+
+    static bool encode(uint32_t tiledGid, Cell& out) {
+        uint32_t gid = tiledGid & TiledGid::GID_MASK;
+        if (gid > MAX_GID) return false;
+        uint32_t flips = (tiledGid >> 29) & 0x7u;
+        out = (Cell)((flips << FLIP_SHIFT) | gid);
+        return true;
+    }
+
+    // 实际占用的堆内存（近似按 64 位 glibc：每次分配 8 字节头并按 16 字节对齐），attach 的外部内存不计
+    size_t memoryBytes() const { return sizeof(*this) + allocationBytes(cells.capacity() * sizeof(Cell)); }
+
+    static size_t footprintBytes(int w, int h) {
+        return sizeof(BasicTileGrid) + allocationBytes((size_t)w * h * sizeof(Cell));
+    }
+
+    // 同尺寸下旧的 vector<vector<int>> 布局的占用，用于内存对比报告
+    static size_t nestedVectorFootprintBytes(int w, int h) {
+        return sizeof(std::vector<std::vector<int>>) +
+               allocationBytes((size_t)h * sizeof(std::vector<int>)) +
+               (size_t)h * allocationBytes((size_t)w * sizeof(int));
+    }
+
+private:
+    static size_t allocationBytes(size_t payload) {
+        if (payload == 0) return 0;
+        return (payload + 8 + 15) / 16 * 16;
+    }
+
+    int width = 0;
+    int height = 0;
+    std::vector<Cell> cells;
+    Cell* base = nullptr;   // 指向 cells 或外部内存
+    bool external = false;
+};
+
+// 每格一个字节的标记网格（碰撞/危险/金币/物品位），只使用 raw 访问
+using TileFlagGrid = BasicTileGrid<uint8_t>;
+
+// 默认 16 位格子；GID 超过 8191 的地图用 -DECHOGIDGE_TILE_CELL_32 编译
+#ifdef ECHOGIDGE_TILE_CELL_32
+using TileGrid = BasicTileGrid<uint32_t>;
+#else
+using TileGrid = BasicTileGrid<uint16_t>;
+#endif
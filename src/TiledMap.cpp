@@ -1,270 +1,584 @@
 #include "TiledMap.h"
+#include "CompiledMap.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include "TextureCache.h"
 #include <fstream>
-#include <iostream>
 #include <stdexcept>
 #include <algorithm>
-#include <SDL2/SDL_image.h>
+#include <cstring>
+#include <filesystem>
 
-TiledMap::TiledMap(const std::string& mapPath, SDL_Renderer* renderer) 
-{
-    std::cout << "Start loading map: " << mapPath << std::endl;
-    
-    std::ifstream file(mapPath);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open map file: " + mapPath);
-    }
-    json j;
-    try {
-        file >> j;
-    } 
-    catch (const std::exception& e) 
-    {
-        throw std::runtime_error("JSON parsing failed: " + std::string(e.what()));
-    }
-
-    // 1. 解析地图基本信息
-    if (!j.contains("tilewidth") || !j["tilewidth"].is_number_integer() ||
-        !j.contains("tileheight") || !j["tileheight"].is_number_integer() ||
-        !j.contains("width") || !j["width"].is_number_integer() ||
-        !j.contains("height") || !j["height"].is_number_integer()) {
-        throw std::runtime_error("Map file missing required properties (tilewidth/tileheight/width/height) or invalid type");
-    }
-    tileWidth = j["tilewidth"].get<int>();
-    tileHeight = j["tileheight"].get<int>();
-    mapWidth = j["width"].get<int>();
-    mapHeight = j["height"].get<int>();
-    std::cout << "Map basic info: " << mapWidth << "x" << mapHeight 
-              << ", tiles: " << tileWidth << "x" << tileHeight << std::endl;
-
-    // 2. 解析瓦片集
-    if (j.contains("tilesets") && j["tilesets"].is_array()) 
-    {
-        for (const auto& ts : j["tilesets"]) 
-        {
-            if (!ts.contains("name") || !ts["name"].is_string() ||
-                !ts.contains("firstgid") || !ts["firstgid"].is_number_integer()) 
-            {
-                std::cerr << "Skipping invalid tileset: Missing 'name' (string) or 'firstgid' (integer)" << std::endl;
-                continue;
-            }
-            std::string name = ts["name"].get<std::string>();
-            int firstGid = ts["firstgid"].get<int>();
-            firstGidMap[name] = firstGid;
-            std::cout << "Processing tileset: " << name << " (firstgid: " << firstGid << ")" << std::endl;
-            if (name == "coin") {
-                coinFirstGid = firstGid;
-                coinTileCount = ts.value("tilecount", 0);
-            }
+namespace {
 
-            // 3. 加载瓦片集纹理 - 修改：加载所有瓦片集纹理，包括items
-            SDL_Texture* tilesetTex = nullptr;
-            if (ts.contains("image") && ts["image"].is_string()) {
-                std::string imagePath = ts["image"].get<std::string>();
-                std::string imgPath = "assets/" + imagePath;
-                tilesetTex = IMG_LoadTexture(renderer, imgPath.c_str());
-                if (!tilesetTex) {
-                    std::cerr << "Failed to load tileset texture: " << name << " - " << IMG_GetError() 
-                              << ", path: " << imgPath << std::endl;
-                    // 创建默认纹理
-                    SDL_Surface* surface = SDL_CreateRGBSurface(0, tileWidth, tileHeight, 32, 0, 0, 0, 0);
-                    SDL_FillRect(surface, nullptr, SDL_MapRGB(surface->format, 128, 128, 128));
-                    tilesetTex = SDL_CreateTextureFromSurface(renderer, surface);
-                    SDL_FreeSurface(surface);
-                } else {
-                    std::cout << "Successfully loaded tileset: " << name << " (" << imgPath << ")" << std::endl;
-                }
-            } else {
-                // 对于没有整体图片的瓦片集（如items），创建默认纹理
-                SDL_Surface* surface = SDL_CreateRGBSurface(0, tileWidth, tileHeight, 32, 0, 0, 0, 0);
-                SDL_FillRect(surface, nullptr, SDL_MapRGB(surface->format, 128, 128, 128));
-                tilesetTex = SDL_CreateTextureFromSurface(renderer, surface);
-                SDL_FreeSurface(surface);
-                std::cout << "Created default texture for tileset: " << name << std::endl;
-            }
-            tilesetMap[name] = tilesetTex;
-
-            // 4. 解析瓦片属性（包括碰撞属性和危险属性）
-            if (ts.contains("tiles") && ts["tiles"].is_array()) 
-            {
-                for (const auto& tile : ts["tiles"]) 
-                {
-                    if (!tile.is_object() || !tile.contains("id") || !tile["id"].is_number_integer()) {
-                        std::cerr << "Skipping invalid tile in " << name << ": Not an object or missing 'id' (integer)" << std::endl;
-                        continue;
-                    }
-                    int localId = tile["id"].get<int>();
-                    int globalId = firstGid + localId;
-
-                    // 处理碰撞属性和危险属性
-                    if (tile.contains("properties") && tile["properties"].is_array()) {
-                        for (const auto& prop : tile["properties"]) {
-                            if (!prop.is_object() || !prop.contains("name") || !prop["name"].is_string()) {
-                                continue;
-                            }
-                            std::string propName = prop["name"].get<std::string>();
-                            
-                            // 处理碰撞属性
-                            if (propName == "Flat_Terrain" && prop.contains("value") && prop["value"].is_boolean()) {
-                                bool propValue = prop["value"].get<bool>();
-                                if (propValue) {
-                                    solidTiles.insert(globalId);
-                                    std::cout << "  - Tile " << globalId << " (local " << localId << ") marked as solid" << std::endl;
-                                }
-                            }
-                            // 处理尖刺危险属性 - 新增
-                            else if (propName == "Spike" && prop.contains("value") && prop["value"].is_boolean()) {
-                                bool propValue = prop["value"].get<bool>();
-                                if (propValue) {
-                                    hazardTiles.insert(globalId);
-                                    std::cout << "  - Tile " << globalId << " (local " << localId << ") marked as HAZARD (Spike)" << std::endl;
-                                }
-                            }
-                        }
-                    }
-
-                    // items瓦片集处理（保持不变）
-                    if (name == "items") {
-                        if (!tile.contains("image") || !tile["image"].is_string() ||
-                            !tile.contains("imagewidth") || !tile["imagewidth"].is_number_integer() ||
-                            !tile.contains("imageheight") || !tile["imageheight"].is_number_integer()) {
-                            std::cerr << "Skipping invalid items tile " << localId << ": Missing 'image' (string) or size (integer)" << std::endl;
-                            continue;
-                        }
-
-                        std::string imagePath = tile["image"].get<std::string>();
-                        std::string imgPath = "assets/" + imagePath;
-                        int imgW = tile["imagewidth"].get<int>();
-                        int imgH = tile["imageheight"].get<int>();
-
-                        SDL_Texture* itemTex = IMG_LoadTexture(renderer, imgPath.c_str());
-                        if (itemTex) {
-                            itemTextures[globalId] = itemTex;
-                            itemSizes[globalId] = {imgW, imgH};
-                            std::cout << "  - Loaded items tile " << globalId << ": " << imgPath << " (" << imgW << "x" << imgH << ")" << std::endl;
-                        } else {
-                            std::cerr << "  - Failed to load items tile " << localId << ": " << IMG_GetError() << ", path: " << imgPath << std::endl;
-                        }
-                    }
-                }
-            }
-        }
+// Tiled 的翻转标记换算成 SDL_RenderCopyEx 的旋转角和翻转：
+// 对角翻转（转置）= 先垂直翻转再顺时针旋转 90 度，此时原本的水平/垂直翻转互换
+void toSdlFlip(uint8_t flip, double& angle, SDL_RendererFlip& sdlFlip) {
+    bool h = flip & TILE_FLIP_HORIZONTAL;
+    bool v = flip & TILE_FLIP_VERTICAL;
+    int result = SDL_FLIP_NONE;
+    if (flip & TILE_FLIP_DIAGONAL) {
+        angle = 90.0;
+        if (!h) result |= SDL_FLIP_VERTICAL;
+        if (v) result |= SDL_FLIP_HORIZONTAL;
+    } else {
+        angle = 0.0;
+        if (h) result |= SDL_FLIP_HORIZONTAL;
+        if (v) result |= SDL_FLIP_VERTICAL;
     }
+    sdlFlip = (SDL_RendererFlip)result;
+}
 
-    // 5. 解析图层（保持不变）
-    if (j.contains("layers") && j["layers"].is_array()) 
-    {
-        for (const auto& layer : j["layers"]) 
-        {
-            if (!layer.is_object() || !layer.contains("name") || !layer["name"].is_string() ||
-                !layer.contains("type") || !layer["type"].is_string()) {
-                std::cerr << "Skipping invalid layer: Not an object or missing 'name'/'type' (string)" << std::endl;
-                continue;
-            }
-            std::string layerName = layer["name"].get<std::string>();
-            std::string layerType = layer["type"].get<std::string>();
-            std::cout << "Processing layer: " << layerName << " (type: " << layerType << ")" << std::endl;
-
-            if (layerType == "imagelayer") 
-            {
-                if (!layer.contains("image") || !layer["image"].is_string()) {
-                    std::cerr << "Imagelayer " << layerName << " missing 'image' (string) field" << std::endl;
-                    continue;
-                }
+// 对四个角（左上、右上、右下、左下）的纹理坐标应用翻转：先对角转置，再水平、垂直
+void applyFlipToCorners(uint8_t flip, SDL_FPoint uv[4]) {
+    if (flip & TILE_FLIP_DIAGONAL) {
+        std::swap(uv[1], uv[3]);
+    }
+    if (flip & TILE_FLIP_HORIZONTAL) {
+        std::swap(uv[0], uv[1]);
+        std::swap(uv[2], uv[3]);
+    }
+    if (flip & TILE_FLIP_VERTICAL) {
+        std::swap(uv[0], uv[3]);
+        std::swap(uv[1], uv[2]);
+    }
+}
 
-                ImageLayer imgLayer;
-                imgLayer.x = layer.value("x", 0);
-                imgLayer.y = layer.value("y", 0);
-                imgLayer.opacity = layer.value("opacity", 1.0f);
-                imgLayer.parallaxX = layer.value("parallaxx", 1.0f);
-                imgLayer.repeatX = layer.value("repeatx", false);
-                imgLayer.offsetx = layer.value("offsetx", 0);
-                imgLayer.offsety = layer.value("offsety", 0);
-
-                std::string imgPath = "assets/" + layer["image"].get<std::string>();
-                imgLayer.texture = IMG_LoadTexture(renderer, imgPath.c_str());
-                if (!imgLayer.texture) {
-                    std::cerr << "Failed to load imagelayer: " << layerName << " - " << IMG_GetError() << ", path: " << imgPath << std::endl;
-                    continue;
-                }
+// 2 的幂返回 log2，否则返回 -1
+int log2Exact(int v) {
+    if (v <= 0 || (v & (v - 1)) != 0) return -1;
+    int shift = 0;
+    while ((1 << shift) < v) ++shift;
+    return shift;
+}
 
-                if (layer.contains("imagewidth") && layer["imagewidth"].is_number_integer() &&
-                    layer.contains("imageheight") && layer["imageheight"].is_number_integer()) {
-                    imgLayer.imageWidth = layer["imagewidth"].get<int>();
-                    imgLayer.imageHeight = layer["imageheight"].get<int>();
-                } else {
-                    SDL_QueryTexture(imgLayer.texture, nullptr, nullptr, &imgLayer.imageWidth, &imgLayer.imageHeight);
-                }
+bool hasExtension(const std::string& path, const char* extension) {
+    const size_t length = std::strlen(extension);
+    return path.size() >= length && path.compare(path.size() - length, length, extension) == 0;
+}
 
-                imageLayers.push_back(imgLayer);
-                std::cout << "Loaded imagelayer: " << layerName << " (" << imgLayer.imageWidth << "x" << imgLayer.imageHeight << ")" << std::endl;
+// 编译地图存在且不比源 .tmj 旧；只发布了 .egmap（没有 .tmj）时也算最新
+bool isCompiledUpToDate(const std::string& compiledPath, const std::string& sourcePath) {
+    // 路径是 UTF-8，用 u8path 构造，Windows 上非 ASCII 路径才能找到文件
+    std::error_code ec;
+    const auto compiledTime = std::filesystem::last_write_time(std::filesystem::u8path(compiledPath), ec);
+    if (ec) return false;
+    const auto sourceTime = std::filesystem::last_write_time(std::filesystem::u8path(sourcePath), ec);
+    if (ec) return true;
+    if (sourceTime > compiledTime) {
+        LOG_WARN(CAT_MAP, "Compiled map " << compiledPath << " is older than " << sourcePath
+                          << ", parsing JSON instead (run EchoGidgeMapC to update it)");
+        return false;
+    }
+    return true;
+}
+
+// 把另一种位宽的格子重新编码成当前 TileGrid 的格式
+template <typename Stored>
+bool convertCells(const Stored* cells, int width, int height, TileGrid& grid) {
+    using StoredGrid = BasicTileGrid<Stored>;
+    grid.resize(width, height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const Stored cell = cells[(size_t)y * width + x];
+            const uint32_t tiledGid = ((uint32_t)StoredGrid::flipOf(cell) << 29) | (uint32_t)StoredGrid::gidOf(cell);
+            if (!grid.setTiled(x, y, tiledGid)) {
+                return false;
             }
+        }
+    }
+    return true;
+}
 
-            if ((layerName == "back" || layerName == "main") && layerType == "tilelayer") 
-            {
-                if (!layer.contains("data") || !layer["data"].is_array() ||
-                    !layer.contains("width") || !layer["width"].is_number_integer() ||
-                    !layer.contains("height") || !layer["height"].is_number_integer()) {
-                    std::cerr << "Tilelayer " << layerName << " missing 'data' (array) or 'width'/'height' (integer)" << std::endl;
-                    continue;
-                }
+}  // namespace
 
-                const auto& data = layer["data"];
-                int layerWidth = layer["width"].get<int>();
-                int layerHeight = layer["height"].get<int>();
-                std::cout << "Tilelayer " << layerName << " size: " << layerWidth << "x" << layerHeight << " tiles" << std::endl;
-
-                std::vector<std::vector<int>> tileLayer(layerHeight, std::vector<int>(layerWidth, 0));
-                for (int y = 0; y < layerHeight; y++) {
-                    for (int x = 0; x < layerWidth; x++) {
-                        int index = y * layerWidth + x;
-                        if (index >= (int)data.size() || !data[index].is_number_integer()) {
-                            tileLayer[y][x] = 0;
-                            continue;
-                        }
-                        tileLayer[y][x] = data[index].get<int>();
-                    }
-                }
+TiledMap::TiledMap(const std::string& mapPath, SDL_Renderer* renderer, bool allowCompiled,
+                   const ImageLoader::Progress& progress)
+{
+    // 没有渲染器时只加载网格和瓦片属性，跳过所有纹理（无界面模拟）
+    headless = (renderer == nullptr);
+    LOG_INFO(CAT_MAP, "Start loading map: " << mapPath << (headless ? " (headless, no textures)" : ""));
+    const Uint64 loadStart = SDL_GetPerformanceCounter();
 
-                if (layerName == "back") {
-                    backLayer = tileLayer;
-                    std::cout << "Back layer loaded: " << backLayer.size() << " rows, " << backLayer[0].size() << " cols" << std::endl;
-                } else if (layerName == "main") {
-                    mainLayer = tileLayer;
-                    std::cout << "Main layer loaded: " << mainLayer.size() << " rows, " << mainLayer[0].size() << " cols" << std::endl;
-                }
-            }
+    // 1~5. 读取地图数据：有最新的编译地图时直接映射，否则解析 JSON
+    std::string error;
+    if (hasExtension(mapPath, ".egmap")) {
+        if (!loadCompiled(mapPath, error)) {
+            throw std::runtime_error("Failed to load compiled map " + mapPath + ": " + error);
+        }
+    } else {
+        const std::string compiledPath = getCompiledPath(mapPath);
+        if (allowCompiled && isCompiledUpToDate(compiledPath, mapPath) && !loadCompiled(compiledPath, error)) {
+            LOG_WARN(CAT_MAP, "Ignoring compiled map " << compiledPath << ": " << error);
+        }
+        if (!compiled) {
+            loadJson(mapPath);
         }
     }
 
     // 6. 计算实际内容尺寸
-    int layerWidth = mainLayer.empty() ? mapWidth : mainLayer[0].size();
-    int layerHeight = mainLayer.empty() ? mapHeight : mainLayer.size();
+    int layerWidth = mainLayer.empty() ? mapWidth : mainLayer.getWidth();
+    int layerHeight = mainLayer.empty() ? mapHeight : mainLayer.getHeight();
     contentPixelWidth = layerWidth * tileWidth;
     contentPixelHeight = layerHeight * tileHeight;
+    tileShiftX = log2Exact(tileWidth);
+    tileShiftY = log2Exact(tileHeight);
 
-    // 7. 标记危险瓦片（修改：现在已经在解析属性时自动标记）
+    // 7. 标记危险瓦片并展开格子标记（编译地图里已经预计算好）
     markTilesAsHazards();
+    if (!compiled) {
+        buildFlagGrid();
+    }
+
+    // 8. 加载纹理，预计算 GID 查找表（渲染时不再遍历瓦片集、查询纹理尺寸）；无界面模式不渲染，不需要
+    if (!headless) {
+        loadTextures(renderer, progress);
+        buildGidTable();
+    }
+
+    // 9. 静态瓦片层分块缓存（块纹理在第一次可见时才创建）
+    if (!headless) {
+        chunkCache.init(contentPixelWidth, contentPixelHeight, CHUNK_TILES * tileWidth, CHUNK_TILES * tileHeight);
+    }
 
     // 加载完成日志
-    std::cout << "Map loading completed!" << std::endl;
-    std::cout << "Content size: " << contentPixelWidth << "x" << contentPixelHeight << " pixels" << std::endl;
-    std::cout << "Solid tiles count: " << solidTiles.size() << std::endl;
-    std::cout << "Hazard tiles count: " << hazardTiles.size() << std::endl;
-    std::cout << "Tilesets loaded: " << tilesetMap.size() << std::endl;
-    std::cout << "Items tiles loaded: " << itemTextures.size() << std::endl;
+    const double loadMs = (double)(SDL_GetPerformanceCounter() - loadStart) * 1000.0 / SDL_GetPerformanceFrequency();
+    LOG_INFO(CAT_MAP, "Map loading completed in " << loadMs << " ms" << (compiled ? " (compiled)" : ""));
+    LOG_INFO(CAT_MAP, "Content size: " << contentPixelWidth << "x" << contentPixelHeight << " pixels");
+    LOG_INFO(CAT_MAP, "Solid tiles count: " << solidTiles.size());
+    LOG_INFO(CAT_MAP, "Hazard tiles count: " << hazardTiles.size());
+    LOG_INFO(CAT_MAP, "Tilesets loaded: " << tilesetMap.size());
+    LOG_INFO(CAT_MAP, "Items tiles loaded: " << itemTextures.size());
+}
+
+std::string TiledMap::getCompiledPath(const std::string& mapPath) {
+    const size_t dot = mapPath.find_last_of('.');
+    const size_t slash = mapPath.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return mapPath + ".egmap";
+    }
+    return mapPath.substr(0, dot) + ".egmap";
+}
+
+// 从编译地图读取：先校验整个文件，通过后才写入成员，失败时对象保持原样（调用方可以改为解析 JSON）
+bool TiledMap::loadCompiled(const std::string& path, std::string& error) {
+    using namespace CompiledMap;
+    MappedFile file;
+    if (!file.open(path)) {
+        error = file.getError();
+        return false;
+    }
+    uint8_t* base = file.data();
+    const uint64_t size = file.size();
+    Header header;
+    if (size < sizeof(header)) {
+        error = "file too small";
+        return false;
+    }
+    std::memcpy(&header, base, sizeof(header));
+    if (header.magic != MAGIC) {
+        error = "not a compiled map";
+        return false;
+    }
+    if (header.version != VERSION || header.headerSize != sizeof(Header)) {
+        error = "unsupported version " + std::to_string(header.version) + ", recompile with EchoGidgeMapC";
+        return false;
+    }
+    if (header.fileSize != size) {
+        error = "file size mismatch (truncated?)";
+        return false;
+    }
+    if (header.tileWidth <= 0 || header.tileHeight <= 0 || (header.cellBits != 16 && header.cellBits != 32)) {
+        error = "invalid header";
+        return false;
+    }
+
+    auto sectionFits = [&](uint64_t offset, uint64_t count, uint64_t elementSize) {
+        return offset % ALIGNMENT == 0 && offset <= size && count <= (size - offset) / elementSize;
+    };
+    auto gridFits = [&](const GridSection& grid, uint64_t cellSize) {
+        return grid.width >= 0 && grid.height >= 0 &&
+               sectionFits(grid.offset, (uint64_t)grid.width * grid.height, cellSize);
+    };
+    if (!sectionFits(header.tilesetOffset, header.tilesetCount, sizeof(TilesetEntry)) ||
+        !sectionFits(header.itemOffset, header.itemCount, sizeof(ItemEntry)) ||
+        !sectionFits(header.imageLayerOffset, header.imageLayerCount, sizeof(ImageLayerEntry)) ||
+        !sectionFits(header.gidFlagOffset, header.gidFlagCount, 1) ||
+        !sectionFits(header.stringOffset, header.stringSize, 1) || header.stringSize == 0 ||
+        base[header.stringOffset + header.stringSize - 1] != '\0' ||
+        !gridFits(header.backLayer, header.cellBits / 8) || !gridFits(header.mainLayer, header.cellBits / 8) ||
+        !gridFits(header.cellFlags, 1)) {
+        error = "corrupt section table";
+        return false;
+    }
+
+    // 格子位宽与本次构建的 TileGrid 一致时直接指向映射内存，否则转换一份（GID 放不下时失败）
+    const bool inPlace = header.cellBits == (uint32_t)TileGrid::CELL_BITS;
+    TileGrid grids[2];
+    const GridSection* sections[2] = {&header.backLayer, &header.mainLayer};
+    for (int i = 0; i < 2; ++i) {
+        const GridSection& section = *sections[i];
+        uint8_t* cells = base + section.offset;
+        bool converted = inPlace;
+        if (inPlace) {
+            grids[i].attach(section.width, section.height, reinterpret_cast<TileGrid::CellType*>(cells));
+        } else if (header.cellBits == 16) {
+            converted = convertCells(reinterpret_cast<const uint16_t*>(cells), section.width, section.height, grids[i]);
+        } else {
+            converted = convertCells(reinterpret_cast<const uint32_t*>(cells), section.width, section.height, grids[i]);
+        }
+        if (!converted) {
+            error = "tile GID exceeds " + std::to_string(TileGrid::CELL_BITS) +
+                    "-bit tile cells, rebuild with ECHOGIDGE_TILE_CELL_32";
+            return false;
+        }
+    }
+    if (!inPlace) {
+        LOG_WARN(CAT_MAP, "Compiled map uses " << header.cellBits << "-bit cells, converted to " << TileGrid::CELL_BITS
+                          << "-bit (recompile to map tile layers in place)");
+    }
+
+    const char* strings = reinterpret_cast<const char*>(base + header.stringOffset);
+    auto stringAt = [&](uint32_t offset) {
+        return offset < header.stringSize ? std::string(strings + offset) : std::string();
+    };
+
+    tileWidth = header.tileWidth;
+    tileHeight = header.tileHeight;
+    mapWidth = header.mapWidth;
+    mapHeight = header.mapHeight;
+    coinFirstGid = header.coinFirstGid;
+    coinTileCount = header.coinTileCount;
+
+    const TilesetEntry* tilesets = reinterpret_cast<const TilesetEntry*>(base + header.tilesetOffset);
+    for (uint32_t i = 0; i < header.tilesetCount; ++i) {
+        TilesetSource source;
+        source.name = stringAt(tilesets[i].name);
+        source.firstGid = tilesets[i].firstGid;
+        source.image = stringAt(tilesets[i].image);
+        tilesetSources.push_back(source);
+    }
+    const ItemEntry* items = reinterpret_cast<const ItemEntry*>(base + header.itemOffset);
+    for (uint32_t i = 0; i < header.itemCount; ++i) {
+        itemSizes[items[i].gid] = {items[i].width, items[i].height};
+        if (items[i].image != NO_STRING) {
+            itemImages[items[i].gid] = stringAt(items[i].image);
+        }
+    }
+    const ImageLayerEntry* layers = reinterpret_cast<const ImageLayerEntry*>(base + header.imageLayerOffset);
+    for (uint32_t i = 0; i < header.imageLayerCount; ++i) {
+        ImageLayer layer;
+        layer.name = stringAt(layers[i].name);
+        layer.image = stringAt(layers[i].image);
+        layer.x = layers[i].x;
+        layer.y = layers[i].y;
+        layer.offsetx = layers[i].offsetX;
+        layer.offsety = layers[i].offsetY;
+        layer.imageWidth = layers[i].imageWidth;
+        layer.imageHeight = layers[i].imageHeight;
+        layer.opacity = layers[i].opacity;
+        layer.parallaxX = layers[i].parallaxX;
+        layer.repeatX = layers[i].repeatX != 0;
+        imageLayers.push_back(layer);
+    }
+
+    // GID 标记表很小，复制一份；solid/hazard 集合只用于日志统计
+    const uint8_t* flags = base + header.gidFlagOffset;
+    gidFlags.assign(flags, flags + header.gidFlagCount);
+    for (uint32_t gid = 0; gid < header.gidFlagCount; ++gid) {
+        if (flags[gid] & TILE_SOLID) solidTiles.insert((int)gid);
+        if (flags[gid] & TILE_HAZARD) hazardTiles.insert((int)gid);
+    }
+
+    backLayer = std::move(grids[0]);
+    mainLayer = std::move(grids[1]);
+    cellFlags.attach(header.cellFlags.width, header.cellFlags.height, base + header.cellFlags.offset);
+    compiledFile = std::move(file);  // 映射地址不变，上面指向它的网格仍然有效
+    compiled = true;
+    LOG_INFO(CAT_MAP, "Mapped compiled map " << path << ": " << size << " bytes, " << mainLayer.getWidth() << "x"
+                      << mainLayer.getHeight() << " tiles" << (inPlace ? " (in place)" : ""));
+    return true;
+}
+
+bool TiledMap::saveCompiled(const std::string& path) const {
+    using namespace CompiledMap;
+    std::string strings;
+    auto addString = [&](const std::string& value) {
+        uint32_t offset = (uint32_t)strings.size();
+        strings += value;
+        strings += '\0';
+        return offset;
+    };
+
+    std::vector<TilesetEntry> tilesets;
+    for (const TilesetSource& source : tilesetSources) {
+        tilesets.push_back({source.firstGid, addString(source.name),
+                            source.image.empty() ? NO_STRING : addString(source.image)});
+    }
+    std::vector<ItemEntry> items;
+    for (const auto& [gid, itemSize] : itemSizes) {
+        auto imageIt = itemImages.find(gid);
+        items.push_back({gid, itemSize.first, itemSize.second,
+                         imageIt == itemImages.end() ? NO_STRING : addString(imageIt->second)});
+    }
+    std::sort(items.begin(), items.end(), [](const ItemEntry& a, const ItemEntry& b) { return a.gid < b.gid; });
+    std::vector<ImageLayerEntry> layers;
+    for (const ImageLayer& layer : imageLayers) {
+        layers.push_back({addString(layer.name), addString(layer.image), layer.x, layer.y, layer.offsetx,
+                          layer.offsety, layer.imageWidth, layer.imageHeight, layer.opacity, layer.parallaxX,
+                          layer.repeatX ? 1u : 0u, 0u});
+    }
+
+    const uint64_t cellSize = sizeof(TileGrid::CellType);
+    Header header = {};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.headerSize = sizeof(Header);
+    header.cellBits = TileGrid::CELL_BITS;
+    header.tileWidth = tileWidth;
+    header.tileHeight = tileHeight;
+    header.mapWidth = mapWidth;
+    header.mapHeight = mapHeight;
+    header.coinFirstGid = coinFirstGid;
+    header.coinTileCount = coinTileCount;
+    header.tilesetCount = (uint32_t)tilesets.size();
+    header.itemCount = (uint32_t)items.size();
+    header.imageLayerCount = (uint32_t)layers.size();
+    header.gidFlagCount = (uint32_t)gidFlags.size();
+
+    uint64_t offset = alignUp(sizeof(Header));
+    auto place = [&](uint64_t bytes) {
+        uint64_t at = offset;
+        offset = alignUp(offset + bytes);
+        return at;
+    };
+    header.tilesetOffset = place(tilesets.size() * sizeof(TilesetEntry));
+    header.itemOffset = place(items.size() * sizeof(ItemEntry));
+    header.imageLayerOffset = place(layers.size() * sizeof(ImageLayerEntry));
+    header.gidFlagOffset = place(gidFlags.size());
+    header.backLayer = {backLayer.getWidth(), backLayer.getHeight(), place(backLayer.cellCount() * cellSize)};
+    header.mainLayer = {mainLayer.getWidth(), mainLayer.getHeight(), place(mainLayer.cellCount() * cellSize)};
+    header.cellFlags = {cellFlags.getWidth(), cellFlags.getHeight(), place(cellFlags.cellCount())};
+    header.stringOffset = place(strings.size());
+    header.stringSize = strings.size();
+    header.fileSize = offset;
+
+    std::ofstream file(std::filesystem::u8path(path), std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        LOG_ERROR(CAT_MAP, "Failed to write compiled map: " << path);
+        return false;
+    }
+    uint64_t written = 0;
+    auto writeAt = [&](uint64_t at, const void* data, uint64_t bytes) {
+        static const char padding[ALIGNMENT] = {};
+        file.write(padding, (std::streamsize)(at - written));
+        file.write(static_cast<const char*>(data), (std::streamsize)bytes);
+        written = at + bytes;
+    };
+    writeAt(0, &header, sizeof(header));
+    writeAt(header.tilesetOffset, tilesets.data(), tilesets.size() * sizeof(TilesetEntry));
+    writeAt(header.itemOffset, items.data(), items.size() * sizeof(ItemEntry));
+    writeAt(header.imageLayerOffset, layers.data(), layers.size() * sizeof(ImageLayerEntry));
+    writeAt(header.gidFlagOffset, gidFlags.data(), gidFlags.size());
+    writeAt(header.backLayer.offset, backLayer.data(), backLayer.cellCount() * cellSize);
+    writeAt(header.mainLayer.offset, mainLayer.data(), mainLayer.cellCount() * cellSize);
+    writeAt(header.cellFlags.offset, cellFlags.data(), cellFlags.cellCount());
+    writeAt(header.stringOffset, strings.data(), strings.size());
+    writeAt(header.fileSize, nullptr, 0);
+    if (!file.good()) {
+        LOG_ERROR(CAT_MAP, "Failed to write compiled map: " << path);
+        return false;
+    }
+    return true;
+}
+
+void TiledMap::loadTextures(SDL_Renderer* renderer, const ImageLoader::Progress& progress) {
+    // 瓦片集、items 瓦片和图像图层的图片一起并行解码，再逐张上传。
+    // 瓦片集和 items 瓦片打包进图集，同一页上的瓦片绘制时不用切换纹理；图像图层是大图，单独上传
+    ImageLoader images;
+    std::vector<int> tilesetImages;
+    for (const TilesetSource& source : tilesetSources) {
+        tilesetImages.push_back(source.image.empty() ? -1 : images.addPacked("assets/" + source.image));
+    }
+    std::vector<std::pair<int, int>> itemImageIndices;  // GID -> images 序号
+    for (const auto& [gid, image] : itemImages) {
+        itemImageIndices.emplace_back(gid, images.addPacked("assets/" + image));
+    }
+    std::vector<int> layerImages;
+    for (const ImageLayer& imgLayer : imageLayers) {
+        layerImages.push_back(images.add("assets/" + imgLayer.image));
+    }
+    images.load(renderer, progress);
+
+    // 瓦片集纹理：没有整张图片的瓦片集（如 items）或图片加载失败时用灰色默认纹理
+    auto createDefaultTexture = [&]() {
+        TextureRegion region;
+        region.texture = TextureCache::acquireSolid(renderer, tileWidth, tileHeight, 128, 128, 128);
+        region.src = {0, 0, tileWidth, tileHeight};
+        return region;
+    };
+    for (size_t i = 0; i < tilesetSources.size(); ++i) {
+        const TilesetSource& source = tilesetSources[i];
+        TextureRegion tilesetTex;
+        if (tilesetImages[i] >= 0) {
+            const int index = tilesetImages[i];
+            tilesetTex = images.takeRegion(index);
+            if (!tilesetTex.texture) {
+                LOG_WARN(CAT_MAP, "Failed to load tileset texture: " << source.name << " - " << images.getError(index)
+                                  << ", path: " << images.getPath(index));
+                tilesetTex = createDefaultTexture();
+            } else {
+                LOG_INFO(CAT_MAP, "Successfully loaded tileset: " << source.name << " (" << images.getPath(index) << ")");
+            }
+        } else {
+            tilesetTex = createDefaultTexture();
+            LOG_INFO(CAT_MAP, "Created default texture for tileset: " << source.name);
+        }
+        if (tilesetTex.texture) {
+            tilesetMap[source.name] = tilesetTex;
+        }
+    }
+
+    for (const auto& [gid, index] : itemImageIndices) {
+        TextureRegion itemTex = images.takeRegion(index);
+        if (itemTex.texture) {
+            itemTextures[gid] = itemTex;
+            LOG_INFO(CAT_MAP, "  - Loaded items tile " << gid << ": " << images.getPath(index) << " ("
+                              << itemSizes[gid].first << "x" << itemSizes[gid].second << ")");
+        } else {
+            LOG_ERROR(CAT_MAP, "  - Failed to load items tile " << gid << ": " << images.getError(index)
+                               << ", path: " << images.getPath(index));
+        }
+    }
+
+    size_t layerIndex = 0;
+    for (auto it = imageLayers.begin(); it != imageLayers.end(); ++layerIndex) {
+        ImageLayer& imgLayer = *it;
+        const int index = layerImages[layerIndex];
+        imgLayer.texture = images.takeTexture(index);
+        if (!imgLayer.texture) {
+            LOG_ERROR(CAT_MAP, "Failed to load imagelayer: " << imgLayer.name << " - " << images.getError(index)
+                               << ", path: " << images.getPath(index));
+            it = imageLayers.erase(it);
+            continue;
+        }
+        if (imgLayer.imageWidth <= 0 || imgLayer.imageHeight <= 0) {
+            SDL_QueryTexture(imgLayer.texture, nullptr, nullptr, &imgLayer.imageWidth, &imgLayer.imageHeight);
+        }
+        LOG_INFO(CAT_MAP, "Loaded imagelayer: " << imgLayer.name << " (" << imgLayer.imageWidth << "x" << imgLayer.imageHeight << ")");
+        ++it;
+    }
+}
+
+void TiledMap::buildGidTable() {
+    // 按 firstgid 升序排列瓦片集，每个 GID 归属于 firstgid <= GID 的最后一个瓦片集
+    std::vector<std::pair<int, TextureRegion>> tilesets;
+    for (const TilesetSource& source : tilesetSources) {
+        auto texIt = tilesetMap.find(source.name);
+        if (texIt != tilesetMap.end() && texIt->second.texture != nullptr) {
+            tilesets.emplace_back(source.firstGid, texIt->second);
+        }
+    }
+    std::sort(tilesets.begin(), tilesets.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    int maxGid = 0;
+    for (const auto& [gid, tex] : tilesets) {
+        maxGid = std::max(maxGid, gid);
+    }
+    for (const auto& [gid, tex] : itemTextures) {
+        maxGid = std::max(maxGid, gid);
+    }
+    gidTable.assign(maxGid + 1, TileInfo{});
+
+    for (size_t i = 0; i < tilesets.size(); ++i) {
+        int firstGid = tilesets[i].first;
+        const TextureRegion& region = tilesets[i].second;
+        int tilesPerRow = region.src.w / tileWidth;
+        int tilesPerCol = region.src.h / tileHeight;
+        int tileCount = tilesPerRow * tilesPerCol;
+        int endGid = firstGid + tileCount;
+        if (i + 1 < tilesets.size()) {
+            endGid = std::min(endGid, tilesets[i + 1].first);
+        }
+        if (endGid > (int)gidTable.size()) {
+            gidTable.resize(endGid);
+        }
+
+        for (int gid = firstGid; gid < endGid; ++gid) {
+            int localId = gid - firstGid;
+            TileInfo& info = gidTable[gid];
+            info.texture = region.texture;
+            info.src = {region.src.x + (localId % tilesPerRow) * tileWidth,
+                        region.src.y + (localId / tilesPerRow) * tileHeight, tileWidth, tileHeight};
+            info.width = tileWidth;
+            info.height = tileHeight;
+        }
+    }
+
+    // items 瓦片使用各自的图片，覆盖瓦片集中的同名 GID
+    for (const auto& [gid, region] : itemTextures) {
+        auto sizeIt = itemSizes.find(gid);
+        if (sizeIt == itemSizes.end()) {
+            continue;
+        }
+        auto [imgW, imgH] = sizeIt->second;
+        TileInfo& info = gidTable[gid];
+        info.texture = region.texture;
+        info.src = region.src;
+        info.width = imgW;
+        info.height = imgH;
+        info.offsetX = 0;
+        info.offsetY = tileHeight - imgH;  // 底部对齐到瓦片格子
+        tileOverhangRight = std::max(tileOverhangRight, info.offsetX + imgW - tileWidth);
+        tileOverhangUp = std::max(tileOverhangUp, -info.offsetY);
+    }
+
+    // 合批渲染用的归一化纹理坐标
+    std::unordered_set<SDL_Texture*> textures;
+    for (TileInfo& info : gidTable) {
+        if (!info.texture) {
+            continue;
+        }
+        textures.insert(info.texture);
+
+        int texW = 0, texH = 0;
+        SDL_QueryTexture(info.texture, nullptr, nullptr, &texW, &texH);
+        if (texW > 0 && texH > 0) {
+            info.uv = {(float)info.src.x / texW, (float)info.src.y / texH,
+                       (float)info.src.w / texW, (float)info.src.h / texH};
+        }
+    }
+
+    // 加载时统一报告找不到纹理的 GID，避免渲染时每帧刷屏
+    int missing = 0;
+    for (const TileGrid* layer : {&backLayer, &mainLayer}) {
+        const TileGrid::CellType* cells = layer->data();
+        for (size_t i = 0; i < layer->cellCount(); ++i) {
+            int tileId = TileGrid::gidOf(cells[i]);
+            if (tileId != 0 && (tileId >= (int)gidTable.size() || !gidTable[tileId].texture)) {
+                ++missing;
+            }
+        }
+    }
+    LOG_INFO(CAT_MAP, "GID table built: " << gidTable.size() << " entries, " << textures.size() << " textures");
+    if (missing > 0) {
+        LOG_WARN(CAT_MAP, missing << " tiles without tileset will be skipped");
+    }
 }
 
 void TiledMap::markTilesAsHazards() {
-    std::cout << "总危险瓦片数量: " << hazardTiles.size() << std::endl;
+    LOG_INFO(CAT_MAP, "总危险瓦片数量: " << hazardTiles.size());
     for (int tileId : hazardTiles) {
-        std::cout << "  危险瓦片 ID: " << tileId << std::endl;
+        LOG_DEBUG(CAT_MAP, "  危险瓦片 ID: " << tileId);
     }
     
     if (hazardTiles.empty()) {
-        std::cout << "可能有错，没有找到任何危险瓦片" << std::endl;
-        std::cout << "检查一下 Tiled 地图中是否有瓦片设置了Spike属性！" << std::endl;
+        LOG_WARN(CAT_MAP, "可能有错，没有找到任何危险瓦片");
+        LOG_WARN(CAT_MAP, "检查一下 Tiled 地图中是否有瓦片设置了Spike属性！");
     } else {
-        std::cout << "Spike属性的瓦片成功标记为危险物" << std::endl;
+        LOG_INFO(CAT_MAP, "Spike属性的瓦片成功标记为危险物");
     }
 }
 
@@ -272,52 +586,233 @@ void TiledMap::markTilesAsHazards() {
 
 TiledMap::~TiledMap() 
 {
-    for (auto& [name, tex] : tilesetMap) {
-        SDL_DestroyTexture(tex);
+    for (auto& [name, region] : tilesetMap) {
+        TextureCache::release(region.texture);
     }
-    for (auto& [id, tex] : itemTextures) {
-        SDL_DestroyTexture(tex);
+    for (auto& [id, region] : itemTextures) {
+        TextureCache::release(region.texture);
     }
     for (auto& layer : imageLayers) {
-        SDL_DestroyTexture(layer.texture);
+        TextureCache::release(layer.texture);
     }
 }
 
 // 危险物检测方法
 bool TiledMap::isHazard(int worldX, int worldY) const {
-    // 将世界坐标转换为原始坐标（考虑缩放）
-    float originalX = (float)worldX / renderScale;
-    float originalY = (float)worldY / renderScale;
-
-    // 计算当前坐标对应的瓦片
-    int tileX = (int)originalX / tileWidth;
-    int tileY = (int)originalY / tileHeight;
-    
-    int layerWidth = mainLayer.empty() ? mapWidth : mainLayer[0].size();
-    int layerHeight = mainLayer.empty() ? mapHeight : mainLayer.size();
-
-    // 边界检查
-    if (tileX < 0 || tileX >= layerWidth || tileY < 0 || tileY >= layerHeight) {
+    int tileX, tileY;
+    if (!worldToTile(worldX, worldY, tileX, tileY)) {
+        return false;
+    }
+    if (!(cellFlags.raw(tileX, tileY) & TILE_HAZARD)) {
         return false;
     }
 
-    // 检查瓦片是否为危险物
-    int tileId = mainLayer[tileY][tileX];
-    bool isHazard = hazardTiles.count(tileId) > 0;
-    
     // 调试输出
     static int hazardDebugCount = 0;
-    if (hazardDebugCount++ % 180 == 0 && isHazard) { // 每3秒输出一次危险物检测
-        std::cout << "危险物的世界坐标: (" << worldX << ", " << worldY 
-                  << ") 原始坐标: (" << originalX << ", " << originalY
-                  << ") 瓦片坐标: (" << tileX << ", " << tileY 
-                  << ") 瓦片ID: " << tileId << std::endl;
+    if (hazardDebugCount++ % 180 == 0) { // 每3秒输出一次危险物检测
+        LOG_TRACE(CAT_MAP, "危险物的世界坐标: (" << worldX << ", " << worldY
+                           << ") 瓦片坐标: (" << tileX << ", " << tileY
+                           << ") 瓦片ID: " << mainLayer.gid(tileX, tileY));
     }
-    
-    return isHazard;
+    return true;
+}
+
+void TiledMap::buildFlagGrid() {
+    // 先算每个 GID 的标记，再展开到格子上
+    int maxGid = (int)gidTable.size() - 1;
+    for (int gid : solidTiles) maxGid = std::max(maxGid, gid);
+    for (int gid : hazardTiles) maxGid = std::max(maxGid, gid);
+    for (const auto& [gid, size] : itemSizes) maxGid = std::max(maxGid, gid);
+    if (coinFirstGid >= 0) maxGid = std::max(maxGid, coinFirstGid + coinTileCount - 1);
+    gidFlags.assign(std::max(maxGid, 0) + 1, 0);
+    for (int gid : solidTiles) gidFlags[gid] |= TILE_SOLID;
+    for (int gid : hazardTiles) gidFlags[gid] |= TILE_HAZARD;
+    for (const auto& [gid, size] : itemSizes) gidFlags[gid] |= TILE_ITEM;
+    if (coinFirstGid >= 0) {
+        for (int gid = coinFirstGid; gid < coinFirstGid + coinTileCount; ++gid) gidFlags[gid] |= TILE_COIN;
+    }
+
+    int w = mainLayer.empty() ? mapWidth : mainLayer.getWidth();
+    int h = mainLayer.empty() ? mapHeight : mainLayer.getHeight();
+    cellFlags.resize(w, h);
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            updateCellFlags(x, y);
+        }
+    }
+}
+
+void TiledMap::updateCellFlags(int tileX, int tileY) {
+    if (!cellFlags.inBounds(tileX, tileY)) return;
+    uint8_t mainFlags = mainLayer.inBounds(tileX, tileY) ? gidFlagsOf(mainLayer.gid(tileX, tileY)) : 0;
+    uint8_t backFlags = backLayer.inBounds(tileX, tileY) ? gidFlagsOf(backLayer.gid(tileX, tileY)) : 0;
+    uint8_t flags = (mainFlags & (TILE_SOLID | TILE_HAZARD)) | ((mainFlags | backFlags) & (TILE_COIN | TILE_ITEM));
+    cellFlags.setRaw(tileX, tileY, flags);
+}
+
+// 一次读 8 个格子做按位或，最后把 8 个字节折叠成一个
+uint8_t TiledMap::scanRowFlags(int tileY, int tileX0, int tileX1) const {
+    if (tileY < 0 || tileY >= cellFlags.getHeight()) return 0;
+    tileX0 = std::max(tileX0, 0);
+    tileX1 = std::min(tileX1, cellFlags.getWidth() - 1);
+    if (tileX0 > tileX1) return 0;
+
+    const uint8_t* p = cellFlags.row(tileY) + tileX0;
+    int count = tileX1 - tileX0 + 1;
+    uint64_t acc = 0;
+    while (count >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        acc |= word;
+        p += 8;
+        count -= 8;
+    }
+    uint8_t result = 0;
+    while (count-- > 0) {
+        result |= *p++;
+    }
+    acc |= acc >> 32;
+    acc |= acc >> 16;
+    acc |= acc >> 8;
+    return result | (uint8_t)acc;
+}
+
+TiledMap::TileQuery TiledMap::queryRect(const SDL_Rect& worldRect) const {
+    TileQuery result;
+    if (worldRect.w <= 0 || worldRect.h <= 0) {
+        return result;
+    }
+
+    int tx0 = worldToTileX(worldRect.x);
+    int ty0 = worldToTileY(worldRect.y);
+    int tx1 = worldToTileX(worldRect.x + worldRect.w - 1);
+    int ty1 = worldToTileY(worldRect.y + worldRect.h - 1);
+    const int gridW = cellFlags.getWidth();
+    const int gridH = cellFlags.getHeight();
+
+    // 行内按字扫描，超出地图的部分直接并入 TILE_SOLID
+    if (tx0 < 0 || ty0 < 0 || tx1 >= gridW || ty1 >= gridH) {
+        result.flags |= TILE_SOLID;
+    }
+    for (int ty = std::max(ty0, 0); ty <= std::min(ty1, gridH - 1); ++ty) {
+        result.flags |= scanRowFlags(ty, tx0, tx1);
+    }
+    return result;
+}
+
+// 扫掠时的容差：贴合格子边界的浮点误差不算进入下一格
+static const float SWEEP_EPSILON = 1e-3f;
+
+TiledMap::SweepResult TiledMap::sweepX(const SDL_FRect& box, float dx) const {
+    SweepResult result;
+    result.distance = dx;
+    if (dx == 0.0f || box.w <= 0.0f || box.h <= 0.0f) {
+        return result;
+    }
+
+    // 碰撞网格是未缩放的地图坐标
+    const float s = invRenderScale;
+    const float tw = (float)tileWidth;
+    const float th = (float)tileHeight;
+    float left = box.x * s;
+    float right = (box.x + box.w) * s;
+    int row0 = (int)std::floor((box.y * s + SWEEP_EPSILON) / th);
+    int row1 = (int)std::ceil(((box.y + box.h) * s - SWEEP_EPSILON) / th) - 1;
+    float move = dx * s;
+
+    if (move > 0) {
+        // 前沿为右边：依次检查右边将要进入的列
+        int firstCol = (int)std::ceil((right - SWEEP_EPSILON) / tw);
+        int lastCol = (int)std::ceil((right + move - SWEEP_EPSILON) / tw) - 1;
+        for (int col = firstCol; col <= lastCol; ++col) {
+            for (int row = row0; row <= row1; ++row) {
+                if (isBlockingCell(col, row)) {
+                    result.hit = true;
+                    result.tile = {col, row};
+                    result.distance = std::max(0.0f, col * tw - right) * renderScale;
+                    return result;
+                }
+            }
+        }
+    } else {
+        int firstCol = (int)std::floor((left + SWEEP_EPSILON) / tw) - 1;
+        int lastCol = (int)std::floor((left + move + SWEEP_EPSILON) / tw);
+        for (int col = firstCol; col >= lastCol; --col) {
+            for (int row = row0; row <= row1; ++row) {
+                if (isBlockingCell(col, row)) {
+                    result.hit = true;
+                    result.tile = {col, row};
+                    result.distance = std::min(0.0f, (col + 1) * tw - left) * renderScale;
+                    return result;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+TiledMap::SweepResult TiledMap::sweepY(const SDL_FRect& box, float dy) const {
+    SweepResult result;
+    result.distance = dy;
+    if (dy == 0.0f || box.w <= 0.0f || box.h <= 0.0f) {
+        return result;
+    }
+
+    const float s = invRenderScale;
+    const float tw = (float)tileWidth;
+    const float th = (float)tileHeight;
+    float top = box.y * s;
+    float bottom = (box.y + box.h) * s;
+    int col0 = (int)std::floor((box.x * s + SWEEP_EPSILON) / tw);
+    int col1 = (int)std::ceil(((box.x + box.w) * s - SWEEP_EPSILON) / tw) - 1;
+    float move = dy * s;
+    const int gridW = cellFlags.getWidth();
+    const int gridH = cellFlags.getHeight();
+
+    // 前沿扫过的每一行用按字扫描检查整段列
+    auto rowBlocked = [&](int row, int& hitCol) {
+        if (row < 0 || row >= gridH || col0 < 0 || col1 >= gridW) {
+            hitCol = std::max(col0, 0);
+            return true;
+        }
+        if (!(scanRowFlags(row, col0, col1) & TILE_SOLID)) {
+            return false;
+        }
+        const uint8_t* cells = cellFlags.row(row);
+        for (hitCol = col0; hitCol < col1 && !(cells[hitCol] & TILE_SOLID); ++hitCol) {
+        }
+        return true;
+    };
+
+    int hitCol = -1;
+    if (move > 0) {
+        int firstRow = (int)std::ceil((bottom - SWEEP_EPSILON) / th);
+        int lastRow = (int)std::ceil((bottom + move - SWEEP_EPSILON) / th) - 1;
+        for (int row = firstRow; row <= lastRow; ++row) {
+            if (rowBlocked(row, hitCol)) {
+                result.hit = true;
+                result.tile = {hitCol, row};
+                result.distance = std::max(0.0f, row * th - bottom) * renderScale;
+                return result;
+            }
+        }
+    } else {
+        int firstRow = (int)std::floor((top + SWEEP_EPSILON) / th) - 1;
+        int lastRow = (int)std::floor((top + move + SWEEP_EPSILON) / th);
+        for (int row = firstRow; row >= lastRow; --row) {
+            if (rowBlocked(row, hitCol)) {
+                result.hit = true;
+                result.tile = {hitCol, row};
+                result.distance = std::min(0.0f, (row + 1) * th - top) * renderScale;
+                return result;
+            }
+        }
+    }
+    return result;
 }
 
 void TiledMap::renderBackground(SDL_Renderer* renderer, const Camera& camera) const {
+    PROFILE_SCOPE("TiledMap::background");
     for (const auto& layer : imageLayers) {
         renderImageLayer(renderer, camera, layer);
     }
@@ -352,7 +847,7 @@ void TiledMap::renderImageLayer(SDL_Renderer* renderer, const Camera& camera, co
                 scaledImgW,
                 std::min(scaledImgH, scaledContentHeight)
             };
-            SDL_RenderCopy(renderer, layer.texture, nullptr, &dest);
+            RenderStats::copy(renderer, layer.texture, nullptr, &dest);
             totalRenderWidth += scaledImgW;
         }
     } else {
@@ -363,192 +858,242 @@ void TiledMap::renderImageLayer(SDL_Renderer* renderer, const Camera& camera, co
             std::min(scaledImgW, scaledContentWidth),
             std::min(scaledImgH, scaledContentHeight)
         };
-        SDL_RenderCopy(renderer, layer.texture, nullptr, &dest);
+        RenderStats::copy(renderer, layer.texture, nullptr, &dest);
     }
 
     // 恢复透明度
     SDL_SetTextureAlphaMod(layer.texture, 255);
 }
 
+const char* TiledMap::getTileRenderModeName(TileRenderMode mode) {
+    switch (mode) {
+        case TILE_RENDER_PER_TILE: return "per-tile";
+        case TILE_RENDER_CHUNKED: return "chunked";
+        case TILE_RENDER_BATCHED: return "batched";
+    }
+    return "unknown";
+}
+
 void TiledMap::renderTiles(SDL_Renderer* renderer, const Camera& camera) const {
+    if (tileRenderMode == TILE_RENDER_BATCHED && !backLayer.empty() && !mainLayer.empty() && !gidTable.empty()) {
+        const SDL_Rect& view = camera.getView();
+        {
+            PROFILE_SCOPE("TiledMap::backLayer");
+            renderTileLayerBatched(renderer, backLayer, view, renderScale);
+        }
+        {
+            PROFILE_SCOPE("TiledMap::mainLayer");
+            renderTileLayerBatched(renderer, mainLayer, view, renderScale);
+        }
+        return;
+    }
+    if (tileRenderMode == TILE_RENDER_CHUNKED && !backLayer.empty() && !mainLayer.empty() && !gidTable.empty()) {
+        // 块纹理按 1:1 烘焙 back + main 两层，绘制时再按 renderScale 缩放
+        auto bake = [this](SDL_Renderer* target, const SDL_Rect& worldRect) {
+            renderTileLayer(target, backLayer, worldRect, 1.0f);
+            renderTileLayer(target, mainLayer, worldRect, 1.0f);
+        };
+        PROFILE_SCOPE("TiledMap::chunkedLayers");
+        if (chunkCache.render(renderer, camera.getView(), renderScale, bake)) {
+            return;
+        }
+    }
     renderBackLayer(renderer, camera);
     renderMainLayer(renderer, camera);
 }
 
+TiledMap::VisibleTileCounts TiledMap::countVisibleTiles(const Camera& camera) const {
+    VisibleTileCounts counts;
+    int scaledTileW = (int)(tileWidth * renderScale);
+    int scaledTileH = (int)(tileHeight * renderScale);
+    if (scaledTileW <= 0 || scaledTileH <= 0) return counts;
+
+    const SDL_Rect view = camera.getView();
+    auto countLayer = [&](const TileGrid& layer) {
+        int startX = std::max(0, view.x / scaledTileW);
+        int startY = std::max(0, view.y / scaledTileH);
+        int endX = std::min(layer.getWidth(), (view.x + view.w) / scaledTileW + 1);
+        int endY = std::min(layer.getHeight(), (view.y + view.h) / scaledTileH + 1);
+        int count = 0;
+        for (int y = startY; y < endY; ++y) {
+            const TileGrid::CellType* row = layer.row(y);
+            for (int x = startX; x < endX; ++x) {
+                count += TileGrid::gidOf(row[x]) != 0;
+            }
+        }
+        return count;
+    };
+    counts.back = countLayer(backLayer);
+    counts.main = countLayer(mainLayer);
+    return counts;
+}
+
+void TiledMap::setTileRenderMode(TileRenderMode mode) {
+    tileRenderMode = mode;
+    if (mode != TILE_RENDER_CHUNKED) {
+        chunkCache.releaseAll();
+    }
+}
+
 void TiledMap::renderBackLayer(SDL_Renderer* renderer, const Camera& camera) const {
-    if (backLayer.empty() || (tilesetMap.empty() && itemTextures.empty())) {
-        std::cerr << "Back layer render skipped: empty layer or no textures" << std::endl;
+    PROFILE_SCOPE("TiledMap::backLayer");
+    if (backLayer.empty() || gidTable.empty()) {
+        LOG_DEBUG(CAT_MAP, "Back layer render skipped: empty layer or no textures");
         return;
     }
+    renderTileLayer(renderer, backLayer, camera.getView(), renderScale);
+}
 
-    const SDL_Rect& view = camera.getView();
-    SDL_Rect srcRect = {0, 0, tileWidth, tileHeight};
-    int layerWidth = backLayer[0].size();
-    int layerHeight = backLayer.size();
-    int scaledTileW = (int)(tileWidth * renderScale);
-    int scaledTileH = (int)(tileHeight * renderScale);
+void TiledMap::renderMainLayer(SDL_Renderer* renderer, const Camera& camera) const {
+    PROFILE_SCOPE("TiledMap::mainLayer");
+    if (mainLayer.empty() || gidTable.empty()) {
+        LOG_DEBUG(CAT_MAP, "Main layer render skipped: empty layer or no textures");
+        return;
+    }
+    renderTileLayer(renderer, mainLayer, camera.getView(), renderScale);
+}
+
+// view 为缩放后的世界坐标视野：相机视野，或烘焙块时的块区域（scale = 1）
+void TiledMap::renderTileLayer(SDL_Renderer* renderer, const TileGrid& layer,
+                               const SDL_Rect& view, float scale) const {
+    int layerWidth = layer.getWidth();
+    int layerHeight = layer.getHeight();
+    int scaledTileW = (int)(tileWidth * scale);
+    int scaledTileH = (int)(tileHeight * scale);
+    if (scaledTileW <= 0 || scaledTileH <= 0) return;
+    const size_t tableSize = gidTable.size();
 
     // 计算视野内的瓦片范围（避免渲染屏幕外瓦片，优化性能）
-    int startX = std::max(0, view.x / scaledTileW);
+    // 左侧/下方多算 items 的伸出量，否则锚点在视野外的大装饰物会突然消失
+    int startX = std::max(0, (view.x - (int)(tileOverhangRight * scale)) / scaledTileW);
     int startY = std::max(0, view.y / scaledTileH);
     int endX = std::min(layerWidth, (view.x + view.w) / scaledTileW + 1);  // +1 确保边缘瓦片渲染
-    int endY = std::min(layerHeight, (view.y + view.h) / scaledTileH + 1);
+    int endY = std::min(layerHeight, (view.y + view.h + (int)(tileOverhangUp * scale)) / scaledTileH + 1);
 
     for (int y = startY; y < endY; y++) {
+        const TileGrid::CellType* row = layer.row(y);
         for (int x = startX; x < endX; x++) {
-            int tileId = backLayer[y][x];
-            if (tileId == 0) continue;  // 跳过空白瓦片
-
-            // 优先渲染 items 瓦片（单独纹理）
-            auto itemTexIt = itemTextures.find(tileId);
-            if (itemTexIt != itemTextures.end()) {
-                auto sizeIt = itemSizes.find(tileId);
-                if (sizeIt != itemSizes.end()) {
-                    auto [imgW, imgH] = sizeIt->second;
-                    // 计算 items 瓦片屏幕坐标（居中对齐到瓦片格子）
-                    SDL_Rect dest = {
-                        (int)(x * scaledTileW - view.x),
-                        (int)(y * scaledTileH - view.y - (imgH * renderScale - scaledTileH)),
-                        (int)(imgW * renderScale),
-                        (int)(imgH * renderScale)
-                    };
-                    SDL_RenderCopy(renderer, itemTexIt->second, nullptr, &dest);
-                }
-                continue;
-            }
+            unsigned tileId = (unsigned)TileGrid::gidOf(row[x]);
+            if (tileId == 0 || tileId >= tableSize) continue;  // 跳过空白瓦片
 
-            // 渲染普通瓦片（basic/Cave1）
-            SDL_Texture* currentTileset = nullptr;
-            int currentFirstGid = 0;
-            // 查找当前瓦片所属的瓦片集（找最大的 firstGid ≤ tileId）
-            for (const auto& [name, gid] : firstGidMap) {
-                if (tileId >= gid && gid > currentFirstGid) {
-                    auto texIt = tilesetMap.find(name);
-                    if (texIt != tilesetMap.end() && texIt->second != nullptr) {
-                        currentFirstGid = gid;
-                        currentTileset = texIt->second;
-                    }
-                }
-            }
-            if (!currentTileset) {
-                std::cerr << "Back layer: No tileset for tileId " << tileId << " at (" << x << "," << y << ")" << std::endl;
-                continue;
-            }
+            const TileInfo& info = gidTable[tileId];
+            if (!info.texture) continue;
 
-            // 计算瓦片在纹理中的坐标
-            int localId = tileId - currentFirstGid;
-            int tilesetW = 0, tilesetH = 0;
-            SDL_QueryTexture(currentTileset, nullptr, nullptr, &tilesetW, &tilesetH);
-            int tilesPerRow = tilesetW / tileWidth;
-            int tilesPerCol = tilesetH / tileHeight;
-            int maxLocalId = tilesPerRow * tilesPerCol - 1;
-
-            // 边界检查（避免纹理越界）
-            if (localId < 0 || localId > maxLocalId) {
-                std::cerr << "Back layer: Invalid localId " << localId << " for tileId " << tileId << " (max: " << maxLocalId << ")" << std::endl;
+            // items 瓦片尺寸与格子不同：底部对齐到格子
+            SDL_Rect dest;
+            dest.w = (int)(info.width * scale);
+            dest.h = (int)(info.height * scale);
+            dest.x = x * scaledTileW - view.x + (int)(info.offsetX * scale);
+            dest.y = y * scaledTileH - view.y + (int)(info.offsetY * scale);
+            if (dest.x >= view.w || dest.y >= view.h || dest.x + dest.w <= 0 || dest.y + dest.h <= 0) {
                 continue;
             }
-
-            srcRect.x = (localId % tilesPerRow) * tileWidth;
-            srcRect.y = (localId / tilesPerRow) * tileHeight;
-            SDL_Rect dest = {
-                (int)(x * scaledTileW - view.x),
-                (int)(y * scaledTileH - view.y),
-                scaledTileW,
-                scaledTileH
-            };
-            SDL_RenderCopy(renderer, currentTileset, &srcRect, &dest);
+            uint8_t flip = TileGrid::flipOf(row[x]);
+            if (flip == TILE_FLIP_NONE) {
+                RenderStats::copy(renderer, info.texture, &info.src, &dest);
+            } else {
+                double angle;
+                SDL_RendererFlip sdlFlip;
+                toSdlFlip(flip, angle, sdlFlip);
+                RenderStats::copyEx(renderer, info.texture, &info.src, &dest, angle, nullptr, sdlFlip);
+            }
         }
     }
 }
 
-void TiledMap::renderMainLayer(SDL_Renderer* renderer, const Camera& camera) const {
-    if (mainLayer.empty() || (tilesetMap.empty() && itemTextures.empty())) {
-        std::cerr << "Main layer render skipped: empty layer or no textures" << std::endl;
-        return;
-    }
-
-    const SDL_Rect& view = camera.getView();
-    SDL_Rect srcRect = {0, 0, tileWidth, tileHeight};
-    int layerWidth = mainLayer[0].size();
-    int layerHeight = mainLayer.size();
-    int scaledTileW = (int)(tileWidth * renderScale);
-    int scaledTileH = (int)(tileHeight * renderScale);
+// 与 renderTileLayer 相同的可见范围和目标矩形，但把同一纹理的连续瓦片收集成三角形，一次 SDL_RenderGeometry。
+// 按行优先顺序遇到纹理切换就先画掉前面的批次：大于一格的 items 瓦片会盖住相邻格子，
+// 不能按纹理重排，否则叠放顺序和逐瓦片渲染不一致
+void TiledMap::renderTileLayerBatched(SDL_Renderer* renderer, const TileGrid& layer,
+                                      const SDL_Rect& view, float scale) const {
+    int layerWidth = layer.getWidth();
+    int layerHeight = layer.getHeight();
+    int scaledTileW = (int)(tileWidth * scale);
+    int scaledTileH = (int)(tileHeight * scale);
+    if (scaledTileW <= 0 || scaledTileH <= 0) return;
+    const size_t tableSize = gidTable.size();
 
-    int startX = std::max(0, view.x / scaledTileW);
+    int startX = std::max(0, (view.x - (int)(tileOverhangRight * scale)) / scaledTileW);
     int startY = std::max(0, view.y / scaledTileH);
     int endX = std::min(layerWidth, (view.x + view.w) / scaledTileW + 1);
-    int endY = std::min(layerHeight, (view.y + view.h) / scaledTileH + 1);
+    int endY = std::min(layerHeight, (view.y + view.h + (int)(tileOverhangUp * scale)) / scaledTileH + 1);
+
+    batchVertices.clear();  // 保留容量
+    SDL_Texture* batchTexture = nullptr;
 
+    const SDL_Color white = {255, 255, 255, 255};
     for (int y = startY; y < endY; y++) {
+        const TileGrid::CellType* row = layer.row(y);
         for (int x = startX; x < endX; x++) {
-            int tileId = mainLayer[y][x];
-            if (tileId == 0) continue;
-
-            // 优先渲染 items 瓦片
-            auto itemTexIt = itemTextures.find(tileId);
-            if (itemTexIt != itemTextures.end()) {
-                auto sizeIt = itemSizes.find(tileId);
-                if (sizeIt != itemSizes.end()) {
-                    auto [imgW, imgH] = sizeIt->second;
-                    SDL_Rect dest = {
-                        (int)(x * scaledTileW - view.x),
-                        (int)(y * scaledTileH - view.y - (imgH * renderScale - scaledTileH)),
-                        (int)(imgW * renderScale),
-                        (int)(imgH * renderScale)
-                    };
-                    SDL_RenderCopy(renderer, itemTexIt->second, nullptr, &dest);
-                }
+            unsigned tileId = (unsigned)TileGrid::gidOf(row[x]);
+            if (tileId == 0 || tileId >= tableSize) continue;
+
+            const TileInfo& info = gidTable[tileId];
+            if (!info.texture) continue;
+
+            int w = (int)(info.width * scale);
+            int h = (int)(info.height * scale);
+            int dx = x * scaledTileW - view.x + (int)(info.offsetX * scale);
+            int dy = y * scaledTileH - view.y + (int)(info.offsetY * scale);
+            if (dx >= view.w || dy >= view.h || dx + w <= 0 || dy + h <= 0) {
                 continue;
             }
 
-            // 渲染普通瓦片
-            SDL_Texture* currentTileset = nullptr;
-            int currentFirstGid = 0;
-            for (const auto& [name, gid] : firstGidMap) {
-                if (tileId >= gid && gid > currentFirstGid) {
-                    auto texIt = tilesetMap.find(name);
-                    if (texIt != tilesetMap.end() && texIt->second != nullptr) {
-                        currentFirstGid = gid;
-                        currentTileset = texIt->second;
-                    }
-                }
+            if (info.texture != batchTexture) {
+                flushTileBatch(renderer, batchTexture);
+                batchTexture = info.texture;
             }
-            if (!currentTileset) {
-                std::cerr << "Main layer: No tileset for tileId " << tileId << " at (" << x << "," << y << ")" << std::endl;
-                continue;
+
+            float x0 = (float)dx, y0 = (float)dy, x1 = (float)(dx + w), y1 = (float)(dy + h);
+            float u0 = info.uv.x, v0 = info.uv.y, u1 = info.uv.x + info.uv.w, v1 = info.uv.y + info.uv.h;
+            // 四个角（左上、右上、右下、左下）的纹理坐标，翻转标记直接作用在 UV 上
+            SDL_FPoint uv[4] = {{u0, v0}, {u1, v0}, {u1, v1}, {u0, v1}};
+            uint8_t flip = TileGrid::flipOf(row[x]);
+            if (flip != TILE_FLIP_NONE) {
+                applyFlipToCorners(flip, uv);
             }
+            batchVertices.push_back({{x0, y0}, white, uv[0]});
+            batchVertices.push_back({{x1, y0}, white, uv[1]});
+            batchVertices.push_back({{x1, y1}, white, uv[2]});
+            batchVertices.push_back({{x0, y1}, white, uv[3]});
+        }
+    }
+    flushTileBatch(renderer, batchTexture);
+}
 
-            int localId = tileId - currentFirstGid;
-            int tilesetW = 0;
-            SDL_QueryTexture(currentTileset, nullptr, nullptr, &tilesetW, nullptr);
-            int tilesPerRow = tilesetW / tileWidth;
-            srcRect.x = (localId % tilesPerRow) * tileWidth;
-            srcRect.y = (localId / tilesPerRow) * tileHeight;
-            SDL_Rect dest = {
-                (int)(x * scaledTileW - view.x),
-                (int)(y * scaledTileH - view.y),
-                scaledTileW,
-                scaledTileH
-            };
-            SDL_RenderCopy(renderer, currentTileset, &srcRect, &dest);
+void TiledMap::flushTileBatch(SDL_Renderer* renderer, SDL_Texture* texture) const {
+    if (batchVertices.empty()) return;
+
+    int quads = (int)batchVertices.size() / 4;
+    if ((int)batchIndices.size() < quads * 6) {
+        int oldQuads = (int)batchIndices.size() / 6;
+        batchIndices.resize(quads * 6);
+        for (int q = oldQuads; q < quads; ++q) {
+            int base = q * 4;
+            int* idx = &batchIndices[q * 6];
+            idx[0] = base; idx[1] = base + 1; idx[2] = base + 2;
+            idx[3] = base + 2; idx[4] = base + 3; idx[5] = base;
         }
     }
+    RenderStats::geometry(renderer, texture, batchVertices.data(), (int)batchVertices.size(),
+                          batchIndices.data(), quads * 6);
+    batchVertices.clear();
 }
 
 std::vector<SDL_FPoint> TiledMap::getCoinPositions() const {
     std::vector<SDL_FPoint> coins;
     if (coinFirstGid < 0 || coinTileCount <= 0) {
-        std::cout << "[Coins] coins tileset not found, skip extraction." << std::endl;
+        LOG_INFO(CAT_MAP, "[Coins] coins tileset not found, skip extraction.");
         return coins;
     }
-    auto scanLayer = [&](const std::vector<std::vector<int>>& layer) {
+    auto scanLayer = [&](const TileGrid& layer) {
         if (layer.empty()) return;
-        const int h = static_cast<int>(layer.size());
-        const int w = static_cast<int>(layer[0].size());
+        const int h = layer.getHeight();
+        const int w = layer.getWidth();
         for (int y = 0; y < h; ++y) {
+            const TileGrid::CellType* row = layer.row(y);
             for (int x = 0; x < w; ++x) {
-                int tileId = layer[y][x];
+                int tileId = TileGrid::gidOf(row[x]);
                 if (isCoinTile(tileId)) {
                     coins.push_back(SDL_FPoint{ static_cast<float>(x * tileWidth), static_cast<float>(y * tileHeight) });
                 }
@@ -557,25 +1102,30 @@ std::vector<SDL_FPoint> TiledMap::getCoinPositions() const {
     };
     scanLayer(mainLayer);
     scanLayer(backLayer);
-    std::cout << "[Coins] extracted " << coins.size() << " coins from map." << std::endl;
+    LOG_INFO(CAT_MAP, "[Coins] extracted " << coins.size() << " coins from map.");
     return coins;
 }
 
 bool TiledMap::clearCoinTileAt(int worldX, int worldY) {
     // 转回原始坐标（考虑 renderScale）
-    float originalX = (float)worldX / renderScale;
-    float originalY = (float)worldY / renderScale;
-    int tileX = static_cast<int>(originalX) / tileWidth;
-    int tileY = static_cast<int>(originalY) / tileHeight;
-
-    auto clearInLayer = [&](std::vector<std::vector<int>>& layer) -> bool {
-        if (layer.empty()) return false;
-        const int h = static_cast<int>(layer.size());
-        const int w = static_cast<int>(layer[0].size());
-        if (tileX < 0 || tileX >= w || tileY < 0 || tileY >= h) return false;
-        int tileId = layer[tileY][tileX];
+    int tileX, tileY;
+    if (!worldToTile(worldX, worldY, tileX, tileY)) {
+        return false;
+    }
+
+    CellEdit edit;
+    edit.x = tileX;
+    edit.y = tileY;
+    edit.back = backLayer.inBounds(tileX, tileY) ? backLayer.raw(tileX, tileY) : 0;
+    edit.main = mainLayer.inBounds(tileX, tileY) ? mainLayer.raw(tileX, tileY) : 0;
+
+    auto clearInLayer = [&](TileGrid& layer) -> bool {
+        if (!layer.inBounds(tileX, tileY)) return false;
+        int tileId = layer.gid(tileX, tileY);
         if (isCoinTile(tileId)) {
-            layer[tileY][tileX] = 0;
+            layer.clear(tileX, tileY);
+            updateCellFlags(tileX, tileY);
+            invalidateTileAt(tileX, tileY, tileId);
             return true;
         }
         return false;
@@ -583,27 +1133,33 @@ bool TiledMap::clearCoinTileAt(int worldX, int worldY) {
 
     bool cleared = clearInLayer(mainLayer);
     cleared = clearInLayer(backLayer) || cleared;
+    if (cleared) {
+        pristineEdits.push_back(edit);
+    }
     return cleared;
 }
 
-// 碰撞检测（基于世界坐标，适配缩放）
-bool TiledMap::isColliding(int worldX, int worldY) const {
-    // 将缩放后的世界坐标转换为原始坐标
-    float originalX = (float)worldX / renderScale;
-    float originalY = (float)worldY / renderScale;
-
-    // 计算当前坐标对应的瓦片
-    int tileX = (int)originalX / tileWidth;
-    int tileY = (int)originalY / tileHeight;
-    int layerWidth = mainLayer.empty() ? mapWidth : mainLayer[0].size();
-    int layerHeight = mainLayer.empty() ? mapHeight : mainLayer.size();
-
-    // 边界检查（超出地图范围视为碰撞）
-    if (tileX < 0 || tileX >= layerWidth || tileY < 0 || tileY >= layerHeight) {
-        return true;
+void TiledMap::restorePristine() {
+    if (pristineEdits.empty()) return;
+    // 同一格子可能被改过多次，倒序写回保证最后留下的是最早记录的原值
+    for (auto it = pristineEdits.rbegin(); it != pristineEdits.rend(); ++it) {
+        if (backLayer.inBounds(it->x, it->y)) {
+            backLayer.setRaw(it->x, it->y, it->back);
+            invalidateTileAt(it->x, it->y, TileGrid::gidOf(it->back));
+        }
+        if (mainLayer.inBounds(it->x, it->y)) {
+            mainLayer.setRaw(it->x, it->y, it->main);
+            invalidateTileAt(it->x, it->y, TileGrid::gidOf(it->main));
+        }
+        updateCellFlags(it->x, it->y);
     }
+    LOG_DEBUG(CAT_MAP, "Restored " << pristineEdits.size() << " edited cells");
+    pristineEdits.clear();
+}
 
-    // 检查瓦片是否为固体
-    int tileId = mainLayer[tileY][tileX];
-    return solidTiles.count(tileId) > 0;
+void TiledMap::invalidateTileAt(int tileX, int tileY, int gid) {
+    if (gid <= 0 || gid >= (int)gidTable.size()) return;
+    const TileInfo& info = gidTable[gid];
+    chunkCache.invalidate({tileX * tileWidth + info.offsetX, tileY * tileHeight + info.offsetY,
+                           info.width, info.height});
 }
@@ -1,20 +1,77 @@
 #pragma once
 #include <SDL2/SDL.h>
+#include <cmath>
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
 #include "nlohmann/json.hpp"
 #include "Camera.h"
+#include "ImageLoader.h"
+#include "MappedFile.h"
+#include "TileChunkCache.h"
+#include "TileGrid.h"
 using json = nlohmann::json;
 
 class TiledMap {
 public:
-    TiledMap(const std::string& mapPath, SDL_Renderer* renderer);
+    // 瓦片层渲染方式：逐瓦片 SDL_RenderCopy、分块缓存，或按纹理合批的 SDL_RenderGeometry（便于对比性能）
+    enum TileRenderMode {
+        TILE_RENDER_PER_TILE,
+        TILE_RENDER_CHUNKED,
+        TILE_RENDER_BATCHED
+    };
+    static const char* getTileRenderModeName(TileRenderMode mode);
+
+    // 每个格子的标记位，加载时预计算：solid/hazard 只看 main 层，coin/item 看 back + main 两层
+    enum TileFlags : uint8_t {
+        TILE_SOLID = 1 << 0,
+        TILE_HAZARD = 1 << 1,
+        TILE_COIN = 1 << 2,
+        TILE_ITEM = 1 << 3
+    };
+
+    // queryRect 的结果：覆盖格子标记的按位或
+    struct TileQuery {
+        uint8_t flags = 0;  // 超出地图的格子按 TILE_SOLID 计
+    };
+
+    // 单轴扫掠结果：distance 为撞上实心格子之前能移动的距离（与请求位移同号）
+    struct SweepResult {
+        float distance = 0.0f;
+        bool hit = false;
+        SDL_Point tile = {-1, -1};  // 撞到的格子
+    };
+
+    // renderer 为空时进入无界面模式：只加载网格和瓦片属性，不加载任何纹理，渲染接口为空操作。
+    // mapPath 是 .tmj 时，旁边有不比它旧的同名 .egmap（EchoGidgeMapC 编译）就改为内存映射编译地图；
+    // allowCompiled 为 false 时总是解析 .tmj。mapPath 也可以直接是 .egmap。
+    // 纹理在工作线程并行解码，progress 每上传完一张回调一次（在调用线程上，可以画加载画面）。
+    TiledMap(const std::string& mapPath, SDL_Renderer* renderer, bool allowCompiled = true,
+             const ImageLoader::Progress& progress = nullptr);
     ~TiledMap();
+    bool isHeadless() const { return headless; }
+    bool isCompiled() const { return compiled; }  // 数据来自内存映射的 .egmap
+    // 把当前地图（瓦片集、图像图层描述、瓦片层和预计算的标记）写成 .egmap
+    bool saveCompiled(const std::string& path) const;
+    static std::string getCompiledPath(const std::string& mapPath);  // xxx.tmj -> xxx.egmap
     void renderBackground(SDL_Renderer* renderer, const Camera& camera) const;
     void renderTiles(SDL_Renderer* renderer, const Camera& camera) const;
-    bool isColliding(int worldX, int worldY) const;
+    // 碰撞检测（基于世界坐标，超出地图范围视为碰撞）
+    bool isColliding(int worldX, int worldY) const {
+        int tileX, tileY;
+        if (!worldToTile(worldX, worldY, tileX, tileY)) return true;
+        return (cellFlags.raw(tileX, tileY) & TILE_SOLID) != 0;
+    }
     bool isHazard(int worldX, int worldY) const;  // 新增：危险物检测
+    uint8_t getTileFlags(int tileX, int tileY) const {
+        return cellFlags.inBounds(tileX, tileY) ? cellFlags.raw(tileX, tileY) : 0;
+    }
+    uint8_t scanRowFlags(int tileY, int tileX0, int tileX1) const;  // [x0, x1] 闭区间内标记的按位或
+    // 一次遍历世界坐标矩形覆盖的所有格子（包括大于一个瓦片的碰撞盒中间的格子）
+    TileQuery queryRect(const SDL_Rect& worldRect) const;
+    // 连续碰撞：矩形 box（世界坐标，半开区间）沿 X/Y 轴移动，只检查前沿扫过的列/行
+    SweepResult sweepX(const SDL_FRect& box, float dx) const;
+    SweepResult sweepY(const SDL_FRect& box, float dy) const;
 
     // 公共接口
     int getMapPixelWidth() const { return mapWidth * tileWidth; }
@@ -22,22 +79,40 @@ public:
     int getTileWidth() const { return tileWidth; }
     int getTileHeight() const { return tileHeight; }
     int getImageLayerCount() const { return imageLayers.size(); }
-    void setRenderScale(float scale) { renderScale = scale; }
+    void setRenderScale(float scale) {
+        renderScale = scale;
+        invRenderScale = scale > 0.0f ? 1.0f / scale : 1.0f;
+    }
     float getRenderScale() const { return renderScale; }
     int getContentPixelWidth() const { return contentPixelWidth; }
     int getContentPixelHeight() const { return contentPixelHeight; }
-    const std::vector<std::vector<int>>& getMainLayer() const { return mainLayer; }
-    const std::vector<std::vector<int>>& getBackLayer() const { return backLayer; }
-    bool isSolidTile(int tileId) const { return solidTiles.count(tileId) > 0; }
-    bool isHazardTile(int tileId) const { return hazardTiles.count(tileId) > 0; }
+    const TileGrid& getMainLayer() const { return mainLayer; }
+    const TileGrid& getBackLayer() const { return backLayer; }
+    bool isSolidTile(int tileId) const { return (gidFlagsOf(tileId) & TILE_SOLID) != 0; }
+    bool isHazardTile(int tileId) const { return (gidFlagsOf(tileId) & TILE_HAZARD) != 0; }
     bool isCoinTile(int gid) const {
         return coinFirstGid >= 0 && gid >= coinFirstGid && gid < coinFirstGid + coinTileCount;
     }
     std::vector<SDL_FPoint> getCoinPositions() const;
     bool clearCoinTileAt(int worldX, int worldY);
+    // 关卡常驻复用：把 clearCoinTileAt 改过的格子还原成加载时的样子，代价只与改动的格子数有关
+    void restorePristine();
+    void setTileRenderMode(TileRenderMode mode);
+    TileRenderMode getTileRenderMode() const { return tileRenderMode; }
+    void invalidateTileCache() { chunkCache.releaseAll(); }  // 渲染目标丢失（设备重置）时调用
+    int getResidentChunks() const { return chunkCache.getResidentChunks(); }
+
+    // 相机视野内非空瓦片数（性能面板用，与渲染方式无关）
+    struct VisibleTileCounts {
+        int back = 0;
+        int main = 0;
+    };
+    VisibleTileCounts countVisibleTiles(const Camera& camera) const;
 
 private:
     struct ImageLayer {
+        std::string name;
+        std::string image;  // 相对 assets/ 的路径
         SDL_Texture* texture = nullptr;
         int x = 0, y = 0;
         float opacity = 1.0f;
@@ -49,27 +124,116 @@ private:
         int offsety = 0;
     };
 
+    // GID -> 绘制信息的查表项（加载时一次性算好，渲染时直接按 GID 下标取）
+    struct TileInfo {
+        SDL_Texture* texture = nullptr;  // nullptr 表示该 GID 没有可用纹理
+        SDL_Rect src = {0, 0, 0, 0};     // 纹理中的源矩形
+        int width = 0;                   // 绘制尺寸（未缩放），items 瓦片为图片原始尺寸
+        int height = 0;
+        int offsetX = 0;                 // 相对瓦片格子左上角的偏移（items 底部对齐格子）
+        int offsetY = 0;
+        SDL_FRect uv = {0, 0, 0, 0};     // 归一化纹理坐标
+    };
+
+    // 瓦片集描述，纹理在 loadTextures 中按它加载；image 为空表示没有整张图片（如 items）
+    struct TilesetSource {
+        std::string name;
+        int firstGid = 0;
+        std::string image;
+    };
+
+    class JsonSax;  // .tmj 的流式解析器（TiledMapJson.cpp），直接写入下面的成员
+    void loadJson(const std::string& mapPath);
+    bool loadCompiled(const std::string& path, std::string& error);
+    void loadTextures(SDL_Renderer* renderer, const ImageLoader::Progress& progress);
     void renderImageLayer(SDL_Renderer* renderer, const Camera& camera, const ImageLayer& layer) const;
     void renderBackLayer(SDL_Renderer* renderer, const Camera& camera) const;
     void renderMainLayer(SDL_Renderer* renderer, const Camera& camera) const;
+    void renderTileLayer(SDL_Renderer* renderer, const TileGrid& layer,
+                         const SDL_Rect& view, float scale) const;
+    void renderTileLayerBatched(SDL_Renderer* renderer, const TileGrid& layer,
+                                const SDL_Rect& view, float scale) const;
+    void flushTileBatch(SDL_Renderer* renderer, SDL_Texture* texture) const;
+    void buildGidTable();
+    void buildFlagGrid();
+    void updateCellFlags(int tileX, int tileY);
+    void invalidateTileAt(int tileX, int tileY, int gid);  // 只让该瓦片覆盖到的缓存块重新烘焙
+    uint8_t gidFlagsOf(int gid) const {
+        return (gid >= 0 && gid < (int)gidFlags.size()) ? gidFlags[gid] : 0;
+    }
+
+    // 世界坐标 -> 瓦片坐标（向下取整，不做边界检查）
+    int worldToTileX(int worldX) const {
+        if (renderScale != 1.0f) worldX = (int)std::floor(worldX * invRenderScale);
+        return tileShiftX >= 0 ? worldX >> tileShiftX : (worldX >= 0 ? worldX / tileWidth : (worldX + 1) / tileWidth - 1);
+    }
+    int worldToTileY(int worldY) const {
+        if (renderScale != 1.0f) worldY = (int)std::floor(worldY * invRenderScale);
+        return tileShiftY >= 0 ? worldY >> tileShiftY : (worldY >= 0 ? worldY / tileHeight : (worldY + 1) / tileHeight - 1);
+    }
+
+    bool isBlockingCell(int tileX, int tileY) const {
+        if (!cellFlags.inBounds(tileX, tileY)) return true;
+        return (cellFlags.raw(tileX, tileY) & TILE_SOLID) != 0;
+    }
+
+    // 世界坐标 -> 瓦片坐标，瓦片尺寸为 2 的幂时只需移位；超出标记网格返回 false
+    bool worldToTile(int worldX, int worldY, int& tileX, int& tileY) const {
+        // 缩放后向下取整再判断负数：直接截断会把 (-1, 0) 之间的坐标算成第 0 格
+        if (renderScale != 1.0f) {
+            worldX = (int)std::floor(worldX * invRenderScale);
+            worldY = (int)std::floor(worldY * invRenderScale);
+        }
+        if (worldX < 0 || worldY < 0) return false;
+        tileX = tileShiftX >= 0 ? worldX >> tileShiftX : worldX / tileWidth;
+        tileY = tileShiftY >= 0 ? worldY >> tileShiftY : worldY / tileHeight;
+        return tileX < cellFlags.getWidth() && tileY < cellFlags.getHeight();
+    }
     void markTilesAsHazards();  // 新增：临时标记危险瓦片
 
+    bool headless = false;
+    bool compiled = false;
+    MappedFile compiledFile;  // 编译地图的映射，瓦片层和 cellFlags 直接指向其中
     int tileWidth = 16;
     int tileHeight = 16;
     int mapWidth = 0;
     int mapHeight = 0;
     float renderScale = 1.0f;
+    float invRenderScale = 1.0f;
+    int tileShiftX = -1;  // log2(tileWidth)，不是 2 的幂时为 -1
+    int tileShiftY = -1;
     int contentPixelWidth = 0;
     int contentPixelHeight = 0;
     std::unordered_set<int> solidTiles;
     std::unordered_set<int> hazardTiles;  // 危险瓦片集合
-    std::vector<std::vector<int>> backLayer;
-    std::vector<std::vector<int>> mainLayer;
-    std::unordered_map<int, SDL_Texture*> itemTextures;
+    TileGrid backLayer;
+    TileGrid mainLayer;
+    std::unordered_map<int, TextureRegion> itemTextures;  // items 瓦片图片在图集中的位置
     std::unordered_map<int, std::pair<int, int>> itemSizes;
+    std::unordered_map<int, std::string> itemImages;  // items 瓦片 GID -> 图片路径（相对 assets/）
     std::vector<ImageLayer> imageLayers;
-    std::unordered_map<std::string, SDL_Texture*> tilesetMap;
-    std::unordered_map<std::string, int> firstGidMap;
+    std::vector<TilesetSource> tilesetSources;
+    std::unordered_map<std::string, TextureRegion> tilesetMap;  // 放得下的瓦片集也在图集里
+    std::vector<TileInfo> gidTable;  // 下标为 GID
+    std::vector<uint8_t> gidFlags;   // 下标为 GID 的 TileFlags
+    TileFlagGrid cellFlags;          // 与 main 层同尺寸的格子标记
+
+    // 运行中被改动的格子及其原值（两层都记），restorePristine 倒序写回
+    struct CellEdit {
+        int x = 0, y = 0;
+        TileGrid::CellType back = 0;
+        TileGrid::CellType main = 0;
+    };
+    std::vector<CellEdit> pristineEdits;
+    int tileOverhangRight = 0;  // items 瓦片超出格子右侧/上方的最大像素，用于视野裁剪和块失效
+    int tileOverhangUp = 0;
+
+    static const int CHUNK_TILES = 32;  // 每个缓存块 32x32 瓦片
+    TileRenderMode tileRenderMode = TILE_RENDER_CHUNKED;
+    mutable TileChunkCache chunkCache;
+    // 合批渲染：同一纹理的连续瓦片共用一组顶点，跨帧复用容量，稳定后不再分配内存
+    mutable std::vector<SDL_Vertex> batchVertices;
+    mutable std::vector<int> batchIndices;  // 所有批次共用的四边形索引（0,1,2, 2,3,0, ...）
     int coinFirstGid = -1;
     int coinTileCount = 0;
 };
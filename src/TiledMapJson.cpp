@@ -0,0 +1,805 @@
+#include "TiledMap.h"
+#include "Log.h"
+#include "Inflate.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#ifdef ECHOGIDGE_ZSTD
+#include <zstd.h>
+#endif
+
+// .tmj 的流式解析：nlohmann::json::sax_parse 逐个事件回调，不构造 json 树。
+// 瓦片层的 data 数组直接编码成 TileGrid 的格子，瓦片属性直接写入 solid/hazard 集合；
+// 除当前瓦片层的格子外只缓存很小的描述信息，整数数组的地图加载峰值内存约为最终地图大小。
+// 图层数据也可以是 Tiled 的 base64 编码（可选 zlib/gzip/zstd 压缩），无限地图的数据按块（chunks）存放。
+// base64 文本要等图层读完才能解码，解码前整段保留：未压缩时每格约 5.3 字节（16 位格子的 2.7 倍），
+// 所以峰值比最终地图多出最大一个图层的编码文本；解码本身分段进行，不保留完整的解码结果。
+//
+// Tiled 按键名字母序写对象（layers 在 tilesets 前、data 在 name/width 前），
+// 所以每个对象的字段先记下来，到 end_object 时再统一校验和提交。
+class TiledMap::JsonSax {
+public:
+    explicit JsonSax(TiledMap& map) : map(map) {}
+
+    // 解析结束后检查地图必需的基本信息
+    void finish() {
+        if (!root.hasTileWidth || !root.hasTileHeight || !root.hasWidth || !root.hasHeight) {
+            throw std::runtime_error("Map file missing required properties (tilewidth/tileheight/width/height) or invalid type");
+        }
+        map.tileWidth = root.tileWidth;
+        map.tileHeight = root.tileHeight;
+        map.mapWidth = root.width;
+        map.mapHeight = root.height;
+        LOG_INFO(CAT_MAP, "Map basic info: " << map.mapWidth << "x" << map.mapHeight
+                          << ", tiles: " << map.tileWidth << "x" << map.tileHeight);
+        if (!chunkedLayers.empty()) {
+            assembleChunkedLayers();
+        }
+    }
+
+    // ---- nlohmann SAX 接口 ----
+    bool null() { return scalar(Scalar()); }
+    bool boolean(bool value) {
+        Scalar s;
+        s.type = Scalar::BOOL;
+        s.boolean = value;
+        return scalar(s);
+    }
+    bool number_integer(json::number_integer_t value) {
+        if (inData()) return dataCell((uint32_t)value);
+        Scalar s;
+        s.type = Scalar::INT;
+        s.integer = value;
+        s.number = (double)value;
+        return scalar(s);
+    }
+    bool number_unsigned(json::number_unsigned_t value) {
+        if (inData()) return dataCell((uint32_t)value);
+        Scalar s;
+        s.type = Scalar::INT;
+        s.integer = (long long)value;
+        s.number = (double)value;
+        return scalar(s);
+    }
+    bool number_float(json::number_float_t value, const json::string_t&) {
+        Scalar s;
+        s.type = Scalar::FLOAT;
+        s.number = value;
+        s.integer = (long long)value;
+        return scalar(s);
+    }
+    bool string(json::string_t& value) {
+        Scalar s;
+        s.type = Scalar::STRING;
+        s.text = &value;
+        return scalar(s);
+    }
+    bool binary(json::binary_t&) { return scalar(Scalar()); }
+
+    bool start_object(std::size_t) { return enter(true); }
+    bool end_object() { return leave(); }
+    bool start_array(std::size_t) { return enter(false); }
+    bool end_array() { return leave(); }
+    bool key(json::string_t& name) {
+        if (skipDepth == 0) lastKey = name;
+        return true;
+    }
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& e) {
+        throw std::runtime_error("JSON parsing failed: " + std::string(e.what()));
+    }
+
+private:
+    // 我们关心的节点；其余子树整体跳过，只计深度
+    enum Frame {
+        FRAME_ROOT,
+        FRAME_TILESETS,
+        FRAME_TILESET,
+        FRAME_TILES,
+        FRAME_TILE,
+        FRAME_PROPERTIES,
+        FRAME_PROPERTY,
+        FRAME_LAYERS,
+        FRAME_LAYER,
+        FRAME_CHUNKS,
+        FRAME_CHUNK,
+        FRAME_DATA
+    };
+
+    struct Scalar {
+        enum Type { NONE, BOOL, INT, FLOAT, STRING };
+        Type type = NONE;
+        bool boolean = false;
+        long long integer = 0;
+        double number = 0.0;
+        std::string* text = nullptr;  // 指向解析器的缓冲区，可以直接 move 走
+        bool isInt() const { return type == INT; }
+        bool isNumber() const { return type == INT || type == FLOAT; }
+    };
+
+    struct RootFields {
+        bool hasTileWidth = false, hasTileHeight = false, hasWidth = false, hasHeight = false;
+        int tileWidth = 0, tileHeight = 0, width = 0, height = 0;
+    };
+
+    struct TileFields {
+        bool hasId = false;
+        int id = 0;
+        bool solid = false;
+        bool hazard = false;
+        bool hasImage = false, hasImageWidth = false, hasImageHeight = false;
+        std::string image;
+        int imageWidth = 0, imageHeight = 0;
+    };
+
+    struct TilesetFields {
+        bool hasName = false, hasFirstGid = false;
+        std::string name;
+        int firstGid = 0;
+        int tileCount = 0;
+        std::string image;
+        std::vector<TileFields> tiles;  // firstgid 可能写在 tiles 之后，结束时再换算成 GID
+    };
+
+    struct PropertyFields {
+        std::string name;
+        bool hasBool = false;
+        bool value = false;
+    };
+
+    // 一段瓦片数据：整数数组边解析边编码成格子；base64 字符串先原样保存，
+    // 因为 encoding 排在 data 之后，要等整个图层读完才知道怎么解码
+    struct DataFields {
+        bool present = false;
+        bool isString = false;
+        std::string encoded;
+        std::vector<TileGrid::CellType> cells;
+        bool overflow = false;
+        uint32_t overflowGid = 0;
+    };
+
+    // 无限地图的一块（块坐标可以为负）
+    struct ChunkFields {
+        DataFields data;
+        int x = 0, y = 0;
+        int width = 0, height = 0;
+        bool hasWidth = false, hasHeight = false;
+    };
+
+    struct LayerFields {
+        bool hasName = false, hasType = false, hasImage = false;
+        bool hasWidth = false, hasHeight = false, hasImageSize = false;
+        std::string name, type;
+        std::string encoding, compression;
+        ImageLayer image;
+        int width = 0, height = 0;
+        int imageWidth = 0, imageHeight = 0;
+        DataFields data;
+        std::vector<ChunkFields> chunks;
+    };
+
+    // 解码完等所有图层读完再拼接的无限地图图层
+    struct ChunkedLayer {
+        TileGrid* grid = nullptr;
+        std::vector<ChunkFields> chunks;
+    };
+
+    bool inData() const { return skipDepth == 0 && !frames.empty() && frames.back() == FRAME_DATA; }
+
+    // 一个 Tiled 原始 GID（含翻转标记）编码后追加，超出格子位宽的先记下，提交图层时报错
+    static void appendCell(DataFields& target, uint32_t tiledGid) {
+        TileGrid::CellType cell = 0;
+        if (!TileGrid::encode(tiledGid, cell) && !target.overflow) {
+            target.overflow = true;
+            target.overflowGid = tiledGid & TiledGid::GID_MASK;
+        }
+        target.cells.push_back(cell);
+    }
+
+    bool dataCell(uint32_t tiledGid) {
+        appendCell(*data, tiledGid);
+        return true;
+    }
+
+    bool enter(bool isObject) {
+        if (skipDepth > 0) {
+            ++skipDepth;
+            return true;
+        }
+        if (frames.empty()) {
+            if (!isObject) throw std::runtime_error("Map file root is not an object");
+            frames.push_back(FRAME_ROOT);
+            return true;
+        }
+
+        const Frame parent = frames.back();
+        if (parent == FRAME_DATA) {
+            data->cells.push_back(0);  // 不是整数的格子按空格子处理
+            skipDepth = 1;
+            return true;
+        }
+
+        int next = -1;
+        if (isObject) {
+            if (parent == FRAME_TILESETS) {
+                tileset = TilesetFields();
+                next = FRAME_TILESET;
+            } else if (parent == FRAME_TILES) {
+                tileset.tiles.emplace_back();
+                next = FRAME_TILE;
+            } else if (parent == FRAME_PROPERTIES) {
+                property = PropertyFields();
+                next = FRAME_PROPERTY;
+            } else if (parent == FRAME_LAYERS) {
+                layer = LayerFields();
+                next = FRAME_LAYER;
+            } else if (parent == FRAME_CHUNKS) {
+                layer.chunks.emplace_back();
+                next = FRAME_CHUNK;
+            }
+        } else if (parent == FRAME_ROOT && lastKey == "tilesets") {
+            next = FRAME_TILESETS;
+        } else if (parent == FRAME_ROOT && lastKey == "layers") {
+            next = FRAME_LAYERS;
+        } else if (parent == FRAME_TILESET && lastKey == "tiles") {
+            next = FRAME_TILES;
+        } else if (parent == FRAME_TILE && lastKey == "properties") {
+            next = FRAME_PROPERTIES;
+        } else if (parent == FRAME_LAYER && lastKey == "data") {
+            // 图层的 width 在 data 之后才出现：按地图尺寸或上一个瓦片层的格子数预留，避免反复扩容
+            size_t reserve = dataCellsHint;
+            if (root.hasWidth && root.hasHeight) reserve = std::max(reserve, (size_t)root.width * root.height);
+            data = &layer.data;
+            beginData(reserve);
+            next = FRAME_DATA;
+        } else if (parent == FRAME_LAYER && lastKey == "chunks") {
+            next = FRAME_CHUNKS;
+        } else if (parent == FRAME_CHUNK && lastKey == "data") {
+            data = &layer.chunks.back().data;
+            beginData(0);
+            next = FRAME_DATA;
+        }
+
+        if (next < 0) {
+            skipDepth = 1;
+        } else {
+            frames.push_back((Frame)next);
+        }
+        return true;
+    }
+
+    bool leave() {
+        if (skipDepth > 0) {
+            --skipDepth;
+            return true;
+        }
+        const Frame frame = frames.back();
+        frames.pop_back();
+        switch (frame) {
+            case FRAME_DATA:
+                if (data == &layer.data) dataCellsHint = data->cells.size();
+                break;
+            case FRAME_TILESET: commitTileset(); break;
+            case FRAME_PROPERTY: commitProperty(); break;
+            case FRAME_LAYER: commitLayer(); break;
+            default: break;
+        }
+        return true;
+    }
+
+    bool scalar(const Scalar& value) {
+        if (skipDepth > 0 || frames.empty()) {
+            return true;
+        }
+        switch (frames.back()) {
+            case FRAME_ROOT: rootField(value); break;
+            case FRAME_TILESET: tilesetField(value); break;
+            case FRAME_TILE: tileField(value); break;
+            case FRAME_PROPERTY: propertyField(value); break;
+            case FRAME_LAYER: layerField(value); break;
+            case FRAME_CHUNK: chunkField(value); break;
+            case FRAME_DATA: data->cells.push_back(0); break;  // 不是整数的格子按空格子处理
+            default: break;
+        }
+        return true;
+    }
+
+    void beginData(size_t reserve) {
+        data->present = true;
+        data->isString = false;
+        data->encoded.clear();
+        data->cells.clear();
+        data->cells.reserve(reserve);
+    }
+
+    // data 是字符串：base64 编码，先保存
+    void dataString(DataFields& target, const Scalar& value) {
+        target.present = true;
+        target.isString = true;
+        target.cells.clear();
+        target.encoded = std::move(*value.text);
+    }
+
+    void rootField(const Scalar& value) {
+        if (!value.isInt()) return;
+        if (lastKey == "tilewidth") {
+            root.tileWidth = (int)value.integer;
+            root.hasTileWidth = true;
+        } else if (lastKey == "tileheight") {
+            root.tileHeight = (int)value.integer;
+            root.hasTileHeight = true;
+        } else if (lastKey == "width") {
+            root.width = (int)value.integer;
+            root.hasWidth = true;
+        } else if (lastKey == "height") {
+            root.height = (int)value.integer;
+            root.hasHeight = true;
+        }
+    }
+
+    void tilesetField(const Scalar& value) {
+        if (lastKey == "name" && value.type == Scalar::STRING) {
+            tileset.name = *value.text;
+            tileset.hasName = true;
+        } else if (lastKey == "firstgid" && value.isInt()) {
+            tileset.firstGid = (int)value.integer;
+            tileset.hasFirstGid = true;
+        } else if (lastKey == "image" && value.type == Scalar::STRING) {
+            tileset.image = *value.text;
+        } else if (lastKey == "tilecount" && value.isNumber()) {
+            tileset.tileCount = (int)value.integer;
+        }
+    }
+
+    void tileField(const Scalar& value) {
+        TileFields& tile = tileset.tiles.back();
+        if (lastKey == "id" && value.isInt()) {
+            tile.id = (int)value.integer;
+            tile.hasId = true;
+        } else if (lastKey == "image" && value.type == Scalar::STRING) {
+            tile.image = *value.text;
+            tile.hasImage = true;
+        } else if (lastKey == "imagewidth" && value.isInt()) {
+            tile.imageWidth = (int)value.integer;
+            tile.hasImageWidth = true;
+        } else if (lastKey == "imageheight" && value.isInt()) {
+            tile.imageHeight = (int)value.integer;
+            tile.hasImageHeight = true;
+        }
+    }
+
+    void propertyField(const Scalar& value) {
+        if (lastKey == "name" && value.type == Scalar::STRING) {
+            property.name = *value.text;
+        } else if (lastKey == "value" && value.type == Scalar::BOOL) {
+            property.value = value.boolean;
+            property.hasBool = true;
+        }
+    }
+
+    void layerField(const Scalar& value) {
+        ImageLayer& image = layer.image;
+        if (value.type == Scalar::STRING) {
+            if (lastKey == "name") {
+                layer.name = *value.text;
+                layer.hasName = true;
+            } else if (lastKey == "type") {
+                layer.type = *value.text;
+                layer.hasType = true;
+            } else if (lastKey == "image") {
+                image.image = *value.text;
+                layer.hasImage = true;
+            } else if (lastKey == "data") {
+                dataString(layer.data, value);
+            } else if (lastKey == "encoding") {
+                layer.encoding = *value.text;
+            } else if (lastKey == "compression") {
+                layer.compression = *value.text;
+            }
+        } else if (value.type == Scalar::BOOL) {
+            if (lastKey == "repeatx") image.repeatX = value.boolean;
+        } else if (value.isNumber()) {
+            if (lastKey == "width" && value.isInt()) {
+                layer.width = (int)value.integer;
+                layer.hasWidth = true;
+            } else if (lastKey == "height" && value.isInt()) {
+                layer.height = (int)value.integer;
+                layer.hasHeight = true;
+            } else if (lastKey == "imagewidth" && value.isInt()) {
+                layer.imageWidth = (int)value.integer;
+            } else if (lastKey == "imageheight" && value.isInt()) {
+                layer.imageHeight = (int)value.integer;
+                layer.hasImageSize = true;
+            } else if (lastKey == "x") {
+                image.x = (int)value.integer;
+            } else if (lastKey == "y") {
+                image.y = (int)value.integer;
+            } else if (lastKey == "offsetx") {
+                image.offsetx = (int)value.integer;
+            } else if (lastKey == "offsety") {
+                image.offsety = (int)value.integer;
+            } else if (lastKey == "opacity") {
+                image.opacity = (float)value.number;
+            } else if (lastKey == "parallaxx") {
+                image.parallaxX = (float)value.number;
+            }
+        }
+    }
+
+    void chunkField(const Scalar& value) {
+        ChunkFields& chunk = layer.chunks.back();
+        if (lastKey == "data" && value.type == Scalar::STRING) {
+            dataString(chunk.data, value);
+        } else if (!value.isInt()) {
+            return;
+        } else if (lastKey == "x") {
+            chunk.x = (int)value.integer;
+        } else if (lastKey == "y") {
+            chunk.y = (int)value.integer;
+        } else if (lastKey == "width") {
+            chunk.width = (int)value.integer;
+            chunk.hasWidth = true;
+        } else if (lastKey == "height") {
+            chunk.height = (int)value.integer;
+            chunk.hasHeight = true;
+        }
+    }
+
+    // 瓦片属性直接落到瓦片上，tileset 结束时再换算 GID 写入 solid/hazard 集合
+    void commitProperty() {
+        if (frames.empty() || frames.back() != FRAME_PROPERTIES || tileset.tiles.empty() || !property.hasBool ||
+            !property.value) {
+            return;
+        }
+        if (property.name == "Flat_Terrain") {
+            tileset.tiles.back().solid = true;
+        } else if (property.name == "Spike") {
+            tileset.tiles.back().hazard = true;
+        }
+    }
+
+    void commitTileset() {
+        if (!tileset.hasName || !tileset.hasFirstGid) {
+            LOG_ERROR(CAT_MAP, "Skipping invalid tileset: Missing 'name' (string) or 'firstgid' (integer)");
+            return;
+        }
+        const std::string& name = tileset.name;
+        const int firstGid = tileset.firstGid;
+        LOG_INFO(CAT_MAP, "Processing tileset: " << name << " (firstgid: " << firstGid << ")");
+        if (name == "coin") {
+            map.coinFirstGid = firstGid;
+            map.coinTileCount = tileset.tileCount;
+        }
+        TilesetSource source;
+        source.name = name;
+        source.firstGid = firstGid;
+        source.image = tileset.image;
+        map.tilesetSources.push_back(source);
+
+        for (const TileFields& tile : tileset.tiles) {
+            if (!tile.hasId) {
+                LOG_ERROR(CAT_MAP, "Skipping invalid tile in " << name << ": Not an object or missing 'id' (integer)");
+                continue;
+            }
+            const int globalId = firstGid + tile.id;
+            if (tile.solid) {
+                map.solidTiles.insert(globalId);
+                LOG_DEBUG(CAT_MAP, "  - Tile " << globalId << " (local " << tile.id << ") marked as solid");
+            }
+            if (tile.hazard) {
+                map.hazardTiles.insert(globalId);
+                LOG_DEBUG(CAT_MAP, "  - Tile " << globalId << " (local " << tile.id << ") marked as HAZARD (Spike)");
+            }
+            // items瓦片集：每个瓦片一张单独的图片
+            if (name == "items") {
+                if (!tile.hasImage || !tile.hasImageWidth || !tile.hasImageHeight) {
+                    LOG_ERROR(CAT_MAP, "Skipping invalid items tile " << tile.id << ": Missing 'image' (string) or size (integer)");
+                    continue;
+                }
+                map.itemImages[globalId] = tile.image;
+                map.itemSizes[globalId] = {tile.imageWidth, tile.imageHeight};
+            }
+        }
+    }
+
+    void commitLayer() {
+        if (!layer.hasName || !layer.hasType) {
+            LOG_ERROR(CAT_MAP, "Skipping invalid layer: Not an object or missing 'name'/'type' (string)");
+            return;
+        }
+        const std::string& layerName = layer.name;
+        LOG_INFO(CAT_MAP, "Processing layer: " << layerName << " (type: " << layer.type << ")");
+
+        if (layer.type == "imagelayer") {
+            if (!layer.hasImage) {
+                LOG_ERROR(CAT_MAP, "Imagelayer " << layerName << " missing 'image' (string) field");
+                return;
+            }
+            ImageLayer imgLayer = layer.image;
+            imgLayer.name = layerName;
+            // 没写尺寸时为 0，加载纹理后再查询
+            if (layer.hasImageSize) {
+                imgLayer.imageWidth = layer.imageWidth;
+                imgLayer.imageHeight = layer.imageHeight;
+            }
+            map.imageLayers.push_back(imgLayer);
+            return;
+        }
+
+        if ((layerName != "back" && layerName != "main") || layer.type != "tilelayer") {
+            return;
+        }
+        TileGrid& tileLayer = (layerName == "back") ? map.backLayer : map.mainLayer;
+
+        // 无限地图：各块先解码，所有图层读完后按共同的包围盒拼成网格
+        if (!layer.chunks.empty()) {
+            ChunkedLayer chunked;
+            chunked.grid = &tileLayer;
+            for (ChunkFields& chunk : layer.chunks) {
+                if (!chunk.data.present || !chunk.hasWidth || !chunk.hasHeight) {
+                    LOG_ERROR(CAT_MAP, "Tilelayer " << layerName << " has a chunk without 'data' or 'width'/'height'");
+                    continue;
+                }
+                if (chunk.width <= 0 || chunk.height <= 0) {
+                    LOG_ERROR(CAT_MAP, "Tilelayer " << layerName << ": skipping chunk at (" << chunk.x << ", "
+                                       << chunk.y << ") with invalid size " << chunk.width << "x" << chunk.height);
+                    continue;
+                }
+                decodeData(chunk.data, chunk.width, chunk.height);
+                // 拼接时按 width x height 整行拷贝，格子数不对的块不能用（base64 数据在 decodeData 里已经检查过）
+                const size_t expected = (size_t)chunk.width * chunk.height;
+                if (chunk.data.cells.size() != expected) {
+                    LOG_ERROR(CAT_MAP, "Tilelayer " << layerName << ": skipping chunk at (" << chunk.x << ", "
+                                       << chunk.y << ") with " << chunk.data.cells.size() << " tiles, expected "
+                                       << expected);
+                    continue;
+                }
+                chunked.chunks.push_back(std::move(chunk));
+            }
+            LOG_INFO(CAT_MAP, "Tilelayer " << layerName << ": " << chunked.chunks.size() << " chunks");
+            chunkedLayers.push_back(std::move(chunked));
+            return;
+        }
+
+        if (!layer.data.present || !layer.hasWidth || !layer.hasHeight) {
+            LOG_ERROR(CAT_MAP, "Tilelayer " << layerName << " missing 'data' (array) or 'width'/'height' (integer)");
+            return;
+        }
+        decodeData(layer.data, layer.width, layer.height);
+        LOG_INFO(CAT_MAP, "Tilelayer " << layerName << " size: " << layer.width << "x" << layer.height << " tiles"
+                          << (layer.data.isString ? " (" + layer.encoding +
+                                                        (layer.compression.empty() ? "" : "+" + layer.compression) + ")"
+                                                  : std::string()));
+        tileLayer.adopt(layer.width, layer.height, std::move(layer.data.cells));
+        LOG_INFO(CAT_MAP, (layerName == "back" ? "Back" : "Main") << " layer loaded: " << tileLayer.getHeight()
+                          << " rows, " << tileLayer.getWidth() << " cols, " << tileLayer.memoryBytes()
+                          << " bytes (nested vector layout: "
+                          << TileGrid::nestedVectorFootprintBytes(layer.width, layer.height) << " bytes)");
+    }
+
+    // base64 / 压缩数据解码成格子；整数数组只检查 GID 位宽。数据损坏时抛异常
+    void decodeData(DataFields& target, int width, int height) {
+        const std::string& layerName = layer.name;
+        if (target.isString) {
+            if (layer.encoding != "base64") {
+                throw std::runtime_error("Tilelayer " + layerName + ": unsupported data encoding '" + layer.encoding + "'");
+            }
+            const size_t expected = (size_t)std::max(width, 0) * std::max(height, 0);
+            target.cells.clear();
+            target.cells.reserve(expected);
+            std::string error;
+            if (!decodeGids(target, expected, error)) {
+                throw std::runtime_error("Tilelayer " + layerName + ": " + error);
+            }
+            std::string().swap(target.encoded);
+            if (target.cells.size() != expected) {
+                throw std::runtime_error("Tilelayer " + layerName + ": decoded " + std::to_string(target.cells.size()) +
+                                         " tiles, expected " + std::to_string(expected));
+            }
+        }
+        if (target.overflow) {
+            throw std::runtime_error("Tile GID " + std::to_string(target.overflowGid) + " in layer " + layerName +
+                                     " exceeds " + std::to_string(TileGrid::CELL_BITS) +
+                                     "-bit tile cells, rebuild with ECHOGIDGE_TILE_CELL_32");
+        }
+    }
+
+    // 解码后的字节是小端 uint32 GID 数组。未压缩的数据边解 base64 边编码进格子；
+    // 压缩数据先解出 base64（只有压缩后的大小），zlib/gzip 再流式解压，每段直接编码进格子，不保留完整的解压结果
+    bool decodeGids(DataFields& target, size_t expected, std::string& error) {
+        const std::string& compression = layer.compression;
+        if (compression.empty()) {
+            return decodeBase64(target.encoded, [&](const uint8_t* chunk, size_t size) {
+                return appendGids(chunk, size, expected, target, error);
+            }, error);
+        }
+        std::vector<uint8_t> bytes;
+        bytes.reserve(target.encoded.size() / 4 * 3);
+        const bool decoded = decodeBase64(target.encoded, [&](const uint8_t* chunk, size_t size) {
+            bytes.insert(bytes.end(), chunk, chunk + size);
+            return true;
+        }, error);
+        if (!decoded) return false;
+        std::string().swap(target.encoded);
+        if (compression == "zlib" || compression == "gzip") {
+            uint8_t carry[4];
+            size_t carryCount = 0;
+            bool ok = true;
+            std::string sinkError;
+            auto sink = [&](const uint8_t* chunk, size_t size) {
+                // 解压分段不一定按 4 字节对齐，跨段的 GID 先拼在 carry 里
+                while (carryCount > 0 && carryCount < 4 && size > 0) {
+                    carry[carryCount++] = *chunk++;
+                    --size;
+                }
+                if (carryCount == 4) {
+                    ok = appendGids(carry, 4, expected, target, sinkError);
+                    carryCount = 0;
+                }
+                const size_t whole = size & ~(size_t)3;
+                ok = ok && appendGids(chunk, whole, expected, target, sinkError);
+                for (size_t i = whole; i < size; ++i) {
+                    carry[carryCount++] = chunk[i];
+                }
+                return ok;
+            };
+            const Inflate::Format format = compression == "zlib" ? Inflate::FORMAT_ZLIB : Inflate::FORMAT_GZIP;
+            if (!Inflate::decompress(bytes.data(), bytes.size(), format, sink, error)) {
+                error = ok ? compression + " data " + error : sinkError;
+                return false;
+            }
+            if (carryCount != 0) {
+                error = "decompressed size is not a multiple of 4";
+                return false;
+            }
+            return true;
+        }
+        if (compression == "zstd") {
+#ifdef ECHOGIDGE_ZSTD
+            std::vector<uint8_t> raw(expected * 4);
+            const size_t size = ZSTD_decompress(raw.data(), raw.size(), bytes.data(), bytes.size());
+            if (ZSTD_isError(size)) {
+                error = std::string("zstd data ") + ZSTD_getErrorName(size);
+                return false;
+            }
+            return appendGids(raw.data(), size, expected, target, error);
+#else
+            error = "zstd compressed layers need a build with ECHOGIDGE_ZSTD=ON (libzstd); "
+                    "or re-save the map in Tiled with zlib/gzip compression";
+            return false;
+#endif
+        }
+        error = "unsupported compression '" + compression + "'";
+        return false;
+    }
+
+    static bool appendGids(const uint8_t* bytes, size_t size, size_t expected, DataFields& target, std::string& error) {
+        if (size % 4 != 0 || target.cells.size() + size / 4 > expected) {
+            error = "tile data size does not match the layer size";
+            return false;
+        }
+        for (size_t i = 0; i < size; i += 4) {
+            const uint32_t tiledGid = bytes[i] | ((uint32_t)bytes[i + 1] << 8) | ((uint32_t)bytes[i + 2] << 16) |
+                                      ((uint32_t)bytes[i + 3] << 24);
+            appendCell(target, tiledGid);
+        }
+        return true;
+    }
+
+    using ByteSink = std::function<bool(const uint8_t* data, size_t size)>;
+
+    // 标准 base64，忽略空白；解码结果按 4 KB 一段交给 sink（除最后一段外都是 4 的倍数，GID 不会跨段）。
+    // 非法字符或长度不对返回 false 并填写 error；sink 返回 false 时直接返回 false，error 由 sink 填写
+    static bool decodeBase64(const std::string& text, const ByteSink& sink, std::string& error) {
+        static const struct Table {
+            int8_t values[256];
+            Table() {
+                std::memset(values, -1, sizeof(values));
+                const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+                for (int i = 0; i < 64; ++i) values[(uint8_t)alphabet[i]] = (int8_t)i;
+            }
+        } table;
+
+        uint8_t buffer[4096];
+        size_t buffered = 0;
+        uint32_t accumulator = 0;
+        int bits = 0;
+        size_t padding = 0;
+        for (char c : text) {
+            if (c == ' ' || c == '\n' || c == '\r' || c == '\t') continue;
+            if (c == '=') {
+                ++padding;
+                continue;
+            }
+            const int value = table.values[(uint8_t)c];
+            if (value < 0 || padding > 0) {
+                error = "invalid base64 data";
+                return false;
+            }
+            accumulator = (accumulator << 6) | (uint32_t)value;
+            bits += 6;
+            if (bits >= 8) {
+                bits -= 8;
+                buffer[buffered++] = (uint8_t)(accumulator >> bits);
+                if (buffered == sizeof(buffer)) {
+                    if (!sink(buffer, buffered)) return false;
+                    buffered = 0;
+                }
+            }
+        }
+        if (padding > 2 || bits >= 6) {
+            error = "invalid base64 data";
+            return false;
+        }
+        return buffered == 0 || sink(buffer, buffered);
+    }
+
+    // 所有无限图层的块取共同的包围盒，平移到从 (0, 0) 开始，back/main 的格子保持对齐
+    void assembleChunkedLayers() {
+        // 块坐标是任意 int，边界用 64 位算，拼出的网格超过 int 范围时抛异常
+        long long minX = 0, minY = 0, maxX = 0, maxY = 0;
+        bool first = true;
+        for (const ChunkedLayer& chunked : chunkedLayers) {
+            for (const ChunkFields& chunk : chunked.chunks) {
+                if (first) {
+                    minX = chunk.x;
+                    minY = chunk.y;
+                    maxX = (long long)chunk.x + chunk.width;
+                    maxY = (long long)chunk.y + chunk.height;
+                    first = false;
+                }
+                minX = std::min(minX, (long long)chunk.x);
+                minY = std::min(minY, (long long)chunk.y);
+                maxX = std::max(maxX, (long long)chunk.x + chunk.width);
+                maxY = std::max(maxY, (long long)chunk.y + chunk.height);
+            }
+        }
+        if (maxX - minX > INT_MAX || maxY - minY > INT_MAX) {
+            throw std::runtime_error("Infinite map chunks span " + std::to_string(maxX - minX) + "x" +
+                                     std::to_string(maxY - minY) + " tiles, too large");
+        }
+        const int width = (int)(maxX - minX);
+        const int height = (int)(maxY - minY);
+        for (ChunkedLayer& chunked : chunkedLayers) {
+            chunked.grid->resize(width, height);
+            for (ChunkFields& chunk : chunked.chunks) {
+                const TileGrid::CellType* cells = chunk.data.cells.data();
+                for (int y = 0; y < chunk.height; ++y) {
+                    std::memcpy(chunked.grid->data() + (size_t)(chunk.y - minY + y) * width + (chunk.x - minX),
+                                cells + (size_t)y * chunk.width, chunk.width * sizeof(TileGrid::CellType));
+                }
+                std::vector<TileGrid::CellType>().swap(chunk.data.cells);
+            }
+        }
+        map.mapWidth = width;
+        map.mapHeight = height;
+        LOG_INFO(CAT_MAP, "Infinite map: tile bounds (" << minX << ", " << minY << ") - (" << maxX << ", " << maxY
+                          << "), shifted to origin, " << width << "x" << height << " tiles");
+    }
+
+    TiledMap& map;
+    std::vector<Frame> frames;
+    int skipDepth = 0;
+    std::string lastKey;
+    size_t dataCellsHint = 0;
+    RootFields root;
+    TilesetFields tileset;
+    PropertyFields property;
+    LayerFields layer;
+    DataFields* data = nullptr;  // 当前 FRAME_DATA 写入的位置（图层或块）
+    std::vector<ChunkedLayer> chunkedLayers;
+};
+
+void TiledMap::loadJson(const std::string& mapPath) {
+    // 直接在文件映射上解析，不需要先把整个文件读进内存
+    MappedFile file;
+    if (!file.open(mapPath)) {
+        throw std::runtime_error("Failed to open map file: " + mapPath);
+    }
+    const char* begin = reinterpret_cast<const char*>(file.data());
+    JsonSax sax(*this);
+    json::sax_parse(begin, begin + file.size(), &sax);
+    sax.finish();
+}
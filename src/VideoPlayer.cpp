@@ -1,9 +1,9 @@
 #include "VideoPlayer.h"
-#include <iostream>
+#include "Log.h"
 
 VideoPlayer::VideoPlayer(SDL_Renderer* rend) : renderer(rend) {
     // 可以在这里加载死亡特效资源
-    std::cout << "VideoPlayer initialized" << std::endl;
+    LOG_DEBUG(CAT_GAME, "VideoPlayer initialized");
 }
 
 VideoPlayer::~VideoPlayer() {
@@ -22,7 +22,7 @@ bool VideoPlayer::playDeathVideo() {
     isVideoPlaying = true;
     videoStartTime = SDL_GetTicks();
     
-    std::cout << "开始播放死亡动画..." << std::endl;
+    LOG_INFO(CAT_GAME, "开始播放死亡动画...");
     // 这里估计要引入更多的库才能播放视频
     // 暂时用简单的计时器模拟
     
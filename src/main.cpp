@@ -1,11 +1,77 @@
 #include "Game.h"
+#include "Log.h"
 #include <SDL2/SDL.h>
 #include <windows.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// --fps=vsync|uncapped|30|60|120|144
+static bool parseFrameMode(const char* value, GameOptions& options)
+{
+    if (std::strcmp(value, "vsync") == 0) {
+        options.frameMode = FramePacer::MODE_VSYNC;
+        return true;
+    }
+    if (std::strcmp(value, "uncapped") == 0) {
+        options.frameMode = FramePacer::MODE_UNCAPPED;
+        return true;
+    }
+    int hz = std::atoi(value);
+    if (hz == 30 || hz == 60 || hz == 120 || hz == 144) {
+        options.frameMode = FramePacer::MODE_CAPPED;
+        options.targetFps = hz;
+        return true;
+    }
+    return false;
+}
 
 int main(int argc, char* argv[]) 
 {
     SetConsoleOutputCP(CP_UTF8);
-    Game game;
-    game.run();
+    Log::init();
+
+    GameOptions options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--fps=", 6) == 0) {
+            if (!parseFrameMode(argv[i] + 6, options)) {
+                std::cerr << "无效的帧率参数 " << argv[i] << "，可选 vsync/uncapped/30/60/120/144" << std::endl;
+            }
+        } else if (std::strncmp(argv[i], "--trace=", 8) == 0) {
+            options.tracePath = argv[i] + 8;
+        } else if (std::strncmp(argv[i], "--record=", 9) == 0) {
+            options.recordPath = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--replay=", 9) == 0) {
+            options.replayPath = argv[i] + 9;
+        } else if (std::strcmp(argv[i], "--headless") == 0) {
+            options.headless = true;
+        } else if (std::strcmp(argv[i], "--headless-render") == 0) {
+            options.headless = true;
+            options.headlessRender = true;
+        } else if (std::strncmp(argv[i], "--headless-runs=", 16) == 0) {
+            options.headless = true;
+            options.headlessRuns = std::max(1, std::atoi(argv[i] + 16));
+        } else if (std::strncmp(argv[i], "--headless-ticks=", 17) == 0) {
+            options.headless = true;
+            options.headlessMaxTicks = std::max(1, std::atoi(argv[i] + 17));
+        } else if (std::strncmp(argv[i], "--texture-budget=", 17) == 0) {
+            options.textureBudgetMB = std::max(1, std::atoi(argv[i] + 17));
+        } else if (std::strncmp(argv[i], "--log-level=", 12) == 0) {
+            Log::Level level;
+            if (Log::parseLevel(argv[i] + 12, level)) {
+                Log::setLevel(level);
+            } else {
+                std::cerr << "无效的日志级别 " << argv[i] << "，可选 trace/debug/info/warn/error/off" << std::endl;
+            }
+        }
+    }
+
+    {
+        Game game(options);
+        game.run();
+    }
+    // Game 析构时的日志也要写出去
+    Log::shutdown();
     return 0;
-}
\ No newline at end of file
+}
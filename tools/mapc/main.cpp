@@ -0,0 +1,174 @@
+#include "Log.h"
+#include "TiledMap.h"
+#include <SDL2/SDL.h>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// EchoGidgeMapC：把 .tmj 编译成 .egmap（格式见 src/CompiledMap.h），游戏运行时直接内存映射，不再解析 JSON。
+// 用法：EchoGidgeMapC 地图.tmj... [--out=输出.egmap]
+// 默认输出到 .tmj 旁边的同名 .egmap；--out 只能配合单个输入。
+// 编译时按无界面模式完整加载一遍地图（与游戏共用同一套解析和标记规则），写出后再读回来逐格比对。
+//
+// EchoGidgeMapC --verify=参考.tmj 地图...：加载每个地图，back/main 格子和碰撞标记与参考地图逐格比对，
+// 有任何不一致返回 1。用于检查同一张地图另存为 base64/zlib/gzip 或无限地图（tools/mapc/fixtures）后解析结果不变；
+// 无限地图按整块补齐，超出参考地图的格子必须为空。
+
+namespace {
+
+bool readOption(const char* arg, const char* name, const char*& value) {
+    size_t length = std::strlen(name);
+    if (std::strncmp(arg, name, length) == 0 && arg[length] == '=') {
+        value = arg + length + 1;
+        return true;
+    }
+    return false;
+}
+
+bool sameGrid(const TileGrid& a, const TileGrid& b) {
+    return a.getWidth() == b.getWidth() && a.getHeight() == b.getHeight() &&
+           (a.cellCount() == 0 || std::memcmp(a.data(), b.data(), a.cellCount() * sizeof(TileGrid::CellType)) == 0);
+}
+
+bool verify(const TiledMap& source, const TiledMap& compiled) {
+    if (!compiled.isCompiled() || !sameGrid(source.getBackLayer(), compiled.getBackLayer()) ||
+        !sameGrid(source.getMainLayer(), compiled.getMainLayer()) ||
+        source.getContentPixelWidth() != compiled.getContentPixelWidth() ||
+        source.getContentPixelHeight() != compiled.getContentPixelHeight() ||
+        source.getImageLayerCount() != compiled.getImageLayerCount()) {
+        return false;
+    }
+    const int w = source.getContentPixelWidth() / source.getTileWidth();
+    const int h = source.getContentPixelHeight() / source.getTileHeight();
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            if (source.getTileFlags(x, y) != compiled.getTileFlags(x, y)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// 第一个不一致的格子写进 where；candidate 可以比 reference 大（无限地图补齐到整块），多出的格子必须为空
+bool sameTiles(const TiledMap& reference, const TiledMap& candidate, std::string& where) {
+    const TileGrid* layers[2][2] = {{&reference.getBackLayer(), &candidate.getBackLayer()},
+                                    {&reference.getMainLayer(), &candidate.getMainLayer()}};
+    const char* names[2] = {"back", "main"};
+    for (int i = 0; i < 2; ++i) {
+        const TileGrid& expected = *layers[i][0];
+        const TileGrid& actual = *layers[i][1];
+        if (actual.getWidth() < expected.getWidth() || actual.getHeight() < expected.getHeight()) {
+            where = std::string(names[i]) + " 层尺寸 " + std::to_string(actual.getWidth()) + "x" +
+                    std::to_string(actual.getHeight()) + "，参考 " + std::to_string(expected.getWidth()) + "x" +
+                    std::to_string(expected.getHeight());
+            return false;
+        }
+        for (int y = 0; y < actual.getHeight(); ++y) {
+            for (int x = 0; x < actual.getWidth(); ++x) {
+                const TileGrid::CellType want = expected.inBounds(x, y) ? expected.raw(x, y) : 0;
+                if (actual.raw(x, y) != want) {
+                    where = std::string(names[i]) + " 层格子 (" + std::to_string(x) + ", " + std::to_string(y) + ")";
+                    return false;
+                }
+            }
+        }
+    }
+    const int w = candidate.getMainLayer().getWidth();
+    const int h = candidate.getMainLayer().getHeight();
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            if (candidate.getTileFlags(x, y) != reference.getTileFlags(x, y)) {
+                where = "碰撞标记 (" + std::to_string(x) + ", " + std::to_string(y) + ")";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool verifyAgainst(const TiledMap& reference, const std::string& path) {
+    try {
+        TiledMap candidate(path, nullptr, false);
+        std::string where;
+        if (!sameTiles(reference, candidate, where)) {
+            std::cerr << "与参考地图不一致: " << path << " " << where << std::endl;
+            return false;
+        }
+        std::cout << path << " 与参考地图一致" << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "加载失败 " << path << ": " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool compileMap(const std::string& inPath, const std::string& outPath) {
+    try {
+        TiledMap source(inPath, nullptr, false);
+        if (!source.saveCompiled(outPath)) {
+            return false;
+        }
+        TiledMap compiled(outPath, nullptr);
+        if (!verify(source, compiled)) {
+            std::cerr << "编译结果与源地图不一致: " << outPath << std::endl;
+            return false;
+        }
+        std::cout << inPath << " -> " << outPath << " (" << source.getMainLayer().getWidth() << "x"
+                  << source.getMainLayer().getHeight() << " 瓦片)" << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "编译失败 " << inPath << ": " << e.what() << std::endl;
+        return false;
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> inputs;
+    std::string outPath;
+    std::string referencePath;
+    for (int i = 1; i < argc; ++i) {
+        const char* value = nullptr;
+        if (readOption(argv[i], "--out", value)) {
+            outPath = value;
+        } else if (readOption(argv[i], "--verify", value)) {
+            referencePath = value;
+        } else if (argv[i][0] == '-') {
+            std::cerr << "未知参数: " << argv[i] << std::endl;
+            return 1;
+        } else {
+            inputs.push_back(argv[i]);
+        }
+    }
+    if (inputs.empty() || (!outPath.empty() && (inputs.size() > 1 || !referencePath.empty()))) {
+        std::cerr << "用法: EchoGidgeMapC 地图.tmj... [--out=输出.egmap]" << std::endl;
+        std::cerr << "      EchoGidgeMapC --verify=参考.tmj 地图..." << std::endl;
+        return 1;
+    }
+
+    // 加载过程的日志只保留警告和错误
+    Log::init();
+    Log::setLevel(Log::LEVEL_WARN);
+    bool ok = true;
+    if (!referencePath.empty()) {
+        try {
+            TiledMap reference(referencePath, nullptr, false);
+            for (const std::string& input : inputs) {
+                ok = verifyAgainst(reference, input) && ok;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "加载参考地图失败 " << referencePath << ": " << e.what() << std::endl;
+            ok = false;
+        }
+    } else {
+        for (const std::string& input : inputs) {
+            ok = compileMap(input, outPath.empty() ? TiledMap::getCompiledPath(input) : outPath) && ok;
+        }
+    }
+    Log::shutdown();
+    return ok ? 0 : 1;
+}
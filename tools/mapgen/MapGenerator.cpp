@@ -0,0 +1,268 @@
+#include "MapGenerator.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const int SPAWN_COLUMNS = 16;  // 玩家出生点 (100, 100) 附近保持平地，没有坑和尖刺
+
+bool hasBoolProperty(const nlohmann::json& tile, const char* name) {
+    if (!tile.contains("properties") || !tile["properties"].is_array()) return false;
+    for (const auto& prop : tile["properties"]) {
+        if (prop.value("name", "") == name && prop.contains("value") && prop["value"].is_boolean()) {
+            return prop["value"].get<bool>();
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+MapGenerator::MapGenerator(const Settings& settings) : settings(settings), rng(settings.seed) {
+    if (this->settings.coins < 0) this->settings.coins = settings.width / 4;
+    if (this->settings.items < 0) this->settings.items = settings.width / 10;
+}
+
+bool MapGenerator::loadTemplate(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "无法打开模板地图: " << path << std::endl;
+        return false;
+    }
+    templateMap = nlohmann::json::parse(file, nullptr, false);
+    if (templateMap.is_discarded() || !templateMap.contains("tilesets") || !templateMap.contains("layers")) {
+        std::cerr << "模板地图不是有效的 .tmj: " << path << std::endl;
+        return false;
+    }
+
+    for (const auto& ts : templateMap["tilesets"]) {
+        const int firstGid = ts.value("firstgid", 0);
+        const std::string name = ts.value("name", "");
+        if (name == "coin") {
+            coinGid = (uint16_t)firstGid;
+        }
+        std::vector<uint16_t> solid;
+        for (const auto& tile : ts.value("tiles", nlohmann::json::array())) {
+            const uint16_t gid = (uint16_t)(firstGid + tile.value("id", 0));
+            if (hasBoolProperty(tile, "Flat_Terrain")) {
+                solid.push_back(gid);
+            } else if (hasBoolProperty(tile, "Spike")) {
+                hazardGids.push_back(gid);
+            } else if (name == "items" && tile.contains("image")) {
+                itemGids.push_back(gid);
+            }
+        }
+        if (!solid.empty()) {
+            solidPools.push_back(std::move(solid));
+        }
+    }
+
+    for (const auto& layer : templateMap["layers"]) {
+        if (layer.value("type", "") != "tilelayer") continue;
+        if (layer.value("name", "") == "back") {
+            backLayerId = layer.value("id", 0);
+            for (const auto& gid : layer.value("data", nlohmann::json::array())) {
+                if (gid.is_number_unsigned() && gid.get<uint32_t>() != 0) {
+                    backGids.push_back((uint16_t)(gid.get<uint32_t>() & 0x1FFFFFFF));
+                }
+            }
+        } else if (layer.value("name", "") == "main") {
+            mainLayerId = layer.value("id", 0);
+        }
+    }
+
+    if (solidPools.empty() || coinGid == 0) {
+        std::cerr << "模板地图缺少 Flat_Terrain 瓦片或 coin 瓦片集: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+uint32_t MapGenerator::nextRandom(uint32_t bound) {
+    return bound == 0 ? 0 : (uint32_t)(((uint64_t)rng() * bound) >> 32);
+}
+
+bool MapGenerator::chance(double probability) {
+    return rng() < probability * 4294967296.0;
+}
+
+uint16_t MapGenerator::pick(const std::vector<uint16_t>& pool) {
+    return pool.empty() ? 0 : pool[nextRandom((uint32_t)pool.size())];
+}
+
+void MapGenerator::generate() {
+    const size_t cells = (size_t)settings.width * settings.height;
+    backLayer.assign(cells, 0);
+    mainLayer.assign(cells, 0);
+    groundTop.assign(settings.width, settings.height);
+    stats = Stats{};
+
+    generateGround();
+    generatePlatforms();
+    placeOnSurface();
+    fillBackLayer();
+}
+
+// 地面：地表高度随机游走，偶尔挖一段坑；每 zoneWidth 列换一个瓦片集
+void MapGenerator::generateGround() {
+    const int h = settings.height;
+    const int baseTop = h - std::max(2, (int)(h * settings.groundRatio + 0.5));
+    const int minTop = std::max(2, h / 4);
+    const int maxTop = h - 2;
+    int top = std::min(std::max(baseTop, minTop), maxTop);
+    int gapLeft = 0;
+
+    for (int x = 0; x < settings.width; ++x) {
+        if (x >= SPAWN_COLUMNS) {
+            if (gapLeft == 0 && chance(settings.gapChance)) {
+                gapLeft = 2 + (int)nextRandom(3);
+            }
+            if (chance(0.3)) {
+                top += chance(0.5) ? 1 : -1;
+                // 向平均高度回拉，避免游走到地图边缘
+                if (top < baseTop - h / 8) ++top;
+                if (top > baseTop + h / 8) --top;
+                top = std::min(std::max(top, minTop), maxTop);
+            }
+        }
+        if (gapLeft > 0) {
+            --gapLeft;
+            continue;
+        }
+
+        groundTop[x] = top;
+        const std::vector<uint16_t>& pool = solidPools[(x / settings.zoneWidth) % solidPools.size()];
+        for (int y = top; y < h; ++y) {
+            cell(mainLayer, x, y) = pick(pool);
+        }
+        stats.solid += h - top;
+    }
+}
+
+void MapGenerator::generatePlatforms() {
+    const long long count = (long long)settings.width * settings.platformsPer100 / 100;
+    for (long long i = 0; i < count; ++i) {
+        const int x0 = SPAWN_COLUMNS + (int)nextRandom((uint32_t)std::max(1, settings.width - SPAWN_COLUMNS));
+        const int length = 3 + (int)nextRandom(6);
+        const int ground = groundTop[x0] < settings.height ? groundTop[x0] : settings.height - 2;
+        const int y = ground - 4 - (int)nextRandom(5);
+        if (y < 2) continue;
+        const std::vector<uint16_t>& pool = solidPools[(x0 / settings.zoneWidth) % solidPools.size()];
+        for (int x = x0; x < std::min(settings.width, x0 + length); ++x) {
+            uint16_t& c = cell(mainLayer, x, y);
+            if (c == 0) {
+                c = pick(pool);
+                ++stats.solid;
+            }
+        }
+    }
+}
+
+// 尖刺、金币和装饰物都放在地表上方的空格里
+void MapGenerator::placeOnSurface() {
+    const int spawnEnd = std::min(SPAWN_COLUMNS, settings.width);
+    if (!hazardGids.empty()) {
+        for (int x = spawnEnd; x < settings.width; ++x) {
+            const int top = groundTop[x];
+            if (top < settings.height && top > 0 && chance(settings.hazardRatio)) {
+                cell(mainLayer, x, top - 1) = pick(hazardGids);
+                ++stats.hazards;
+            }
+        }
+    }
+
+    auto placeRandom = [&](long long count, auto gidOf, int maxLift, long long& placed) {
+        const long long attempts = count * 4;
+        for (long long i = 0; i < attempts && placed < count; ++i) {
+            const int x = spawnEnd + (int)nextRandom((uint32_t)std::max(1, settings.width - spawnEnd));
+            if (x >= settings.width || groundTop[x] >= settings.height) continue;
+            const int y = groundTop[x] - 1 - (int)nextRandom((uint32_t)maxLift + 1);
+            if (y < 0) continue;
+            uint16_t& c = cell(mainLayer, x, y);
+            if (c == 0) {
+                c = gidOf();
+                ++placed;
+            }
+        }
+    };
+    placeRandom(settings.coins, [&] { return coinGid; }, 3, stats.coins);
+    if (!itemGids.empty()) {
+        placeRandom(settings.items, [&] { return pick(itemGids); }, 0, stats.items);
+    }
+}
+
+void MapGenerator::fillBackLayer() {
+    if (backGids.empty()) return;
+    for (int x = 0; x < settings.width; ++x) {
+        const int top = std::min(groundTop[x], settings.height);
+        for (int y = 0; y < top; ++y) {
+            if (chance(settings.backDensity)) {
+                cell(backLayer, x, y) = pick(backGids);
+                ++stats.back;
+            }
+        }
+    }
+}
+
+bool MapGenerator::writeLayer(std::FILE* file, const std::vector<uint16_t>& layer, int id, const char* name) const {
+    std::fputs("{\"data\":[", file);
+    std::string buffer;
+    buffer.reserve(1 << 20);
+    for (size_t i = 0; i < layer.size(); ++i) {
+        if (i > 0) buffer += ',';
+        buffer += std::to_string(layer[i]);
+        if (buffer.size() >= (1 << 20) - 16) {
+            std::fwrite(buffer.data(), 1, buffer.size(), file);
+            buffer.clear();
+        }
+    }
+    std::fwrite(buffer.data(), 1, buffer.size(), file);
+    std::fprintf(file,
+                 "],\"height\":%d,\"id\":%d,\"name\":\"%s\",\"opacity\":1,\"type\":\"tilelayer\",\"visible\":true,"
+                 "\"width\":%d,\"x\":0,\"y\":0}",
+                 settings.height, id, name, settings.width);
+    return !std::ferror(file);
+}
+
+bool MapGenerator::write(const std::string& path) const {
+    // 除瓦片层以外的内容（瓦片集、图像图层、地图属性）照抄模板，瓦片层在占位符处流式写入
+    nlohmann::json header = templateMap;
+    header["width"] = settings.width;
+    header["height"] = settings.height;
+    nlohmann::json imageLayers = nlohmann::json::array();
+    for (const auto& layer : templateMap["layers"]) {
+        if (layer.value("type", "") != "tilelayer") {
+            imageLayers.push_back(layer);
+        }
+    }
+    const std::string placeholder = "@@TILE_LAYERS@@";
+    header["layers"] = placeholder;
+    const std::string text = header.dump();
+    const size_t split = text.find("\"" + placeholder + "\"");
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "无法写入地图: " << path << std::endl;
+        return false;
+    }
+    std::fwrite(text.data(), 1, split, file);
+    std::fputc('[', file);
+    for (const auto& layer : imageLayers) {
+        const std::string dumped = layer.dump();
+        std::fwrite(dumped.data(), 1, dumped.size(), file);
+        std::fputc(',', file);
+    }
+    bool ok = writeLayer(file, backLayer, backLayerId, "back");
+    std::fputc(',', file);
+    ok = writeLayer(file, mainLayer, mainLayerId, "main") && ok;
+    std::fputc(']', file);
+    const size_t rest = split + placeholder.size() + 2;
+    std::fwrite(text.data() + rest, 1, text.size() - rest, file);
+    std::fputc('\n', file);
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        std::cerr << "地图写入失败: " << path << std::endl;
+    }
+    return ok;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "nlohmann/json.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// 压力测试地图生成器：按给定尺寸和密度生成与 Tiled 兼容的 .tmj，
+// 瓦片集和背景图层直接沿用模板地图（level1.tmj），因此生成的地图能被 TiledMap 原样加载。
+class MapGenerator {
+public:
+    struct Settings {
+        int width = 100;               // 瓦片数
+        int height = 50;
+        double groundRatio = 0.3;      // 地面平均占地图高度的比例（main 层的实心瓦片密度）
+        int platformsPer100 = 6;       // 每 100 列的浮空平台数
+        double gapChance = 0.02;       // 每列开始一段坑的概率
+        double hazardRatio = 0.05;     // 地表放尖刺的列的比例
+        int coins = -1;                // 金币数，-1 表示按宽度取 width / 4
+        int items = -1;                // 装饰物数，-1 表示 width / 10
+        double backDensity = 0.25;     // back 层在地面以上的填充比例
+        int zoneWidth = 64;            // 每隔多少列换一个瓦片集的地面瓦片
+        uint32_t seed = 1;
+    };
+
+    struct Stats {
+        long long solid = 0;
+        long long hazards = 0;
+        long long coins = 0;
+        long long items = 0;
+        long long back = 0;
+    };
+
+    explicit MapGenerator(const Settings& settings);
+
+    // 读取模板地图的瓦片集、图像图层，并按瓦片属性整理出各类瓦片的 GID
+    bool loadTemplate(const std::string& path);
+    void generate();
+    // 地图数据直接流式写出，20000x2000 这样的尺寸也不需要在内存里构造 JSON DOM
+    bool write(const std::string& path) const;
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    Settings settings;
+    Stats stats;
+    std::mt19937 rng;
+
+    nlohmann::json templateMap;
+    std::vector<std::vector<uint16_t>> solidPools;  // 每个有 Flat_Terrain 瓦片的瓦片集一组
+    std::vector<uint16_t> hazardGids;
+    std::vector<uint16_t> itemGids;
+    std::vector<uint16_t> backGids;                 // 模板 back 层里出现过的 GID（按出现次数重复）
+    uint16_t coinGid = 0;
+    int backLayerId = 0;
+    int mainLayerId = 0;
+
+    std::vector<uint16_t> backLayer;
+    std::vector<uint16_t> mainLayer;
+    std::vector<int> groundTop;  // 每列地面最上面一格的 y，height 表示这一列是坑
+
+    // 不用 std::uniform_int_distribution：它的结果随标准库实现而变，同一种子在不同编译器上会生成不同地图
+    uint32_t nextRandom(uint32_t bound);
+    bool chance(double probability);
+    uint16_t pick(const std::vector<uint16_t>& pool);
+
+    uint16_t& cell(std::vector<uint16_t>& layer, int x, int y) { return layer[(size_t)y * settings.width + x]; }
+    void generateGround();
+    void generatePlatforms();
+    void placeOnSurface();
+    void fillBackLayer();
+    bool writeLayer(std::FILE* file, const std::vector<uint16_t>& layer, int id, const char* name) const;
+};
@@ -0,0 +1,83 @@
+#include "MapGenerator.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// EchoGidgeMapGen：生成压力测试用的 .tmj 地图
+// 用法：EchoGidgeMapGen --width=2000 --height=200 [--ground=0.3] [--platforms=6] [--gaps=0.02]
+//       [--hazards=0.05] [--coins=N] [--items=N] [--back=0.25] [--zone=64] [--seed=1]
+//       [--template=assets/maps/level1.tmj] [--out=assets/maps/stress_2000x200.tmj]
+// 在仓库根目录或构建目录运行；生成的地图引用的图片路径与模板相同，所以要放在同一个 assets 下使用。
+
+static bool readOption(const char* arg, const char* name, const char*& value) {
+    size_t length = std::strlen(name);
+    if (std::strncmp(arg, name, length) == 0 && arg[length] == '=') {
+        value = arg + length + 1;
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char* argv[]) {
+    MapGenerator::Settings settings;
+    std::string templatePath = "assets/maps/level1.tmj";
+    std::string outPath;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* value = nullptr;
+        if (readOption(argv[i], "--width", value)) {
+            settings.width = std::atoi(value);
+        } else if (readOption(argv[i], "--height", value)) {
+            settings.height = std::atoi(value);
+        } else if (readOption(argv[i], "--ground", value)) {
+            settings.groundRatio = std::atof(value);
+        } else if (readOption(argv[i], "--platforms", value)) {
+            settings.platformsPer100 = std::atoi(value);
+        } else if (readOption(argv[i], "--gaps", value)) {
+            settings.gapChance = std::atof(value);
+        } else if (readOption(argv[i], "--hazards", value)) {
+            settings.hazardRatio = std::atof(value);
+        } else if (readOption(argv[i], "--coins", value)) {
+            settings.coins = std::atoi(value);
+        } else if (readOption(argv[i], "--items", value)) {
+            settings.items = std::atoi(value);
+        } else if (readOption(argv[i], "--back", value)) {
+            settings.backDensity = std::atof(value);
+        } else if (readOption(argv[i], "--zone", value)) {
+            settings.zoneWidth = std::atoi(value);
+        } else if (readOption(argv[i], "--seed", value)) {
+            settings.seed = (uint32_t)std::strtoul(value, nullptr, 10);
+        } else if (readOption(argv[i], "--template", value)) {
+            templatePath = value;
+        } else if (readOption(argv[i], "--out", value)) {
+            outPath = value;
+        } else {
+            std::cerr << "未知参数: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    if (settings.width < 20 || settings.height < 8 || settings.zoneWidth < 1) {
+        std::cerr << "地图至少 20x8 个瓦片，--zone 至少为 1" << std::endl;
+        return 1;
+    }
+    if (outPath.empty()) {
+        outPath = "assets/maps/stress_" + std::to_string(settings.width) + "x" + std::to_string(settings.height) +
+                  ".tmj";
+    }
+
+    MapGenerator generator(settings);
+    if (!generator.loadTemplate(templatePath)) {
+        return 1;
+    }
+    generator.generate();
+    if (!generator.write(outPath)) {
+        return 1;
+    }
+
+    const MapGenerator::Stats& stats = generator.getStats();
+    std::cout << "已生成 " << outPath << ": " << settings.width << "x" << settings.height << " 瓦片, 地面 "
+              << stats.solid << ", 尖刺 " << stats.hazards << ", 金币 " << stats.coins << ", 装饰物 " << stats.items
+              << ", back 层 " << stats.back << std::endl;
+    return 0;
+}